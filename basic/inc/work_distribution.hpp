@@ -0,0 +1,55 @@
+#ifndef WORK_DISTRIBUTION_HPP
+#define WORK_DISTRIBUTION_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "mpi.h"
+
+namespace WORK {
+
+/*
+ * How items of the range are assigned to the processes:
+ * - block   - contiguous blocks of equal sizes, first processes get one item more;
+ * - cyclic  - blocks of 'chunk' items dealt to the processes round-robin;
+ * - dynamic - master-worker: process 0 hands out 'chunk' items per request
+ *             to the processes which have finished their previous ones.
+ *             Process 0 only serves the requests, unless it is the only one.
+ */
+enum class schedule { block, cyclic, dynamic };
+
+/* Throws std::invalid_argument on unknown name */
+schedule schedule_from_string(const std::string& name);
+
+const char* to_string(schedule kind);
+
+struct options {
+
+  schedule kind = schedule::block;
+
+  /* Items of a cyclic block or of a dynamic request */
+  uint64_t chunk = 1;
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+};
+
+using item_handler = std::function<void(uint64_t item)>;
+
+/*
+ * Collective over 'opts.comm'. Every item of [begin, end) is passed to 'handler'
+ * on exactly one process. Returns the number of items handled by the calling process.
+ * Throws std::invalid_argument on zero chunk.
+ */
+uint64_t distribute(uint64_t begin, uint64_t end, const item_handler& handler,
+                    const options& opts = options{});
+
+/*
+ * Collective over 'comm'. Concatenation of the 'local' strings of all processes
+ * in the rank order on process 0, empty string on the rest.
+ */
+std::string gather_output(const std::string& local, MPI_Comm comm = MPI_COMM_WORLD);
+
+} // namespace WORK
+
+#endif // WORK_DISTRIBUTION_HPP
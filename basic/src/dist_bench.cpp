@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "work_distribution.hpp"
+
+/*
+ * Compares the schedules of the work distribution on items of uneven costs.
+ * Cost of an item is a number of units, a unit is a fixed number of floating-point
+ * iterations. For each cost profile and schedule the benchmark reports the time
+ * of the slowest process and the load imbalance: the largest number of units
+ * handled by a process over the mean one (processes which handle no items
+ * by design, the master of the dynamic schedule, are not counted).
+ */
+
+struct Profile {
+
+  std::string name;
+  uint64_t (*cost)(uint64_t item, uint64_t items);
+};
+
+/* Deterministic hash of the item number, so that all processes agree on the costs */
+static uint64_t mix(uint64_t value) {
+
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  return value;
+}
+
+static const std::vector<Profile> Profiles = {
+  /* Same cost of every item */
+  {"uniform", [](uint64_t, uint64_t) -> uint64_t { return 1; }},
+  /* Cost grows along the range, from 1 to 9 units */
+  {"ramp",    [](uint64_t item, uint64_t items) -> uint64_t { return 1 + 8 * item / items; }},
+  /* Every 256th item on average costs 512 units */
+  {"spikes",  [](uint64_t item, uint64_t) -> uint64_t { return (mix(item) % 256 == 0)? 512 : 1; }},
+  /* Every 8th block of 8 items costs 16 units per item, the period of the cyclic deal */
+  {"periodic", [](uint64_t item, uint64_t) -> uint64_t { return (item / 8 % 8 == 0)? 16 : 1; }}
+};
+
+struct Bench_options {
+
+  uint64_t items = 20000;
+  uint64_t chunk = 8;
+
+  /* Floating-point iterations per cost unit */
+  uint64_t unit = 1000;
+};
+
+/* Throws std::invalid_argument on unknown or malformed option */
+static Bench_options parse_options(int argc, char** argv) {
+
+  Bench_options options;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    uint64_t value = std::stoull(argv[arg_idx + 1]);
+
+    if (name == "--items") {
+      options.items = value;
+    } else if (name == "--chunk") {
+      options.chunk = value;
+    } else if (name == "--unit") {
+      options.unit = value;
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.items == 0 || options.chunk == 0 || options.unit == 0) {
+    throw std::invalid_argument("items, chunk and unit must be positive");
+  }
+
+  return options;
+}
+
+/* Work of 'iters' dependent iterations, the result is kept so that it is not optimized out */
+static double busy_work(uint64_t iters, double value) {
+
+  for (uint64_t iter = 0; iter < iters; ++iter) {
+    value = value * 0.999999 + 1e-6;
+  }
+
+  return value;
+}
+
+int main(int argc, char** argv) {
+
+  MPI::MPI_env mpi_env(argc, argv);
+
+  int size, rank;
+
+  int res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Bench_options options;
+
+  try {
+
+    options = parse_options(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " [--items <N>] [--chunk <N>] [--unit <iterations>]\n";
+    }
+
+    return EXIT_FAILURE;
+  }
+
+  const WORK::schedule schedules[] = {
+    WORK::schedule::block, WORK::schedule::cyclic, WORK::schedule::dynamic
+  };
+
+  if (rank == 0) {
+    std::cout << "Processes: " << size << ", items: " << options.items << ", chunk: "
+              << options.chunk << ", unit: " << options.unit << " iterations\n";
+    std::cout << std::left << std::setw(10) << "profile" << std::setw(10) << "schedule"
+              << std::right << std::setw(12) << "time, s" << std::setw(12) << "imbalance" << "\n";
+  }
+
+  double sink = 0;
+
+  for (const Profile& profile : Profiles) {
+    for (WORK::schedule kind : schedules) {
+
+      WORK::options opts;
+      opts.kind  = kind;
+      opts.chunk = options.chunk;
+
+      uint64_t units = 0;
+
+      res = MPI_Barrier(MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+
+      double start = MPI_Wtime();
+
+      WORK::distribute(0, options.items, [&](uint64_t item) {
+
+        uint64_t cost = profile.cost(item, options.items);
+
+        sink = busy_work(cost * options.unit, sink);
+        units += cost;
+      }, opts);
+
+      double elapsed = MPI_Wtime() - start;
+
+      double slowest;
+      res = MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+
+      std::vector<uint64_t> all_units(rank == 0 ? size : 0);
+      res = MPI_Gather(&units, 1, MPI_UINT64_T, all_units.data(), 1, MPI_UINT64_T, 0,
+                       MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+
+      if (rank != 0) {
+        continue;
+      }
+
+      /* Master of the dynamic schedule only serves the requests */
+      if (kind == WORK::schedule::dynamic && size > 1) {
+        all_units.erase(all_units.begin());
+      }
+
+      double mean = 0;
+      for (uint64_t proc_units : all_units) {
+        mean += static_cast<double>(proc_units) / all_units.size();
+      }
+
+      double imbalance = *std::max_element(all_units.begin(), all_units.end()) / mean;
+
+      std::cout << std::left << std::setw(10) << profile.name << std::setw(10)
+                << WORK::to_string(kind) << std::right << std::fixed << std::setprecision(4)
+                << std::setw(12) << slowest << std::setprecision(3) << std::setw(12) << imbalance
+                << std::defaultfloat << std::endl;
+    }
+  }
+
+  /* Result of the work is used, so that it is not optimized out */
+  if (sink < 0) {
+    std::cout << sink << "\n";
+  }
+
+  return 0;
+}
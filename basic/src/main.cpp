@@ -1,8 +1,12 @@
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include "mpi.h"
 #include "mpi_support.hpp"
+#include "work_distribution.hpp"
 
 static const unsigned MAX = 100U;
 
@@ -17,27 +21,59 @@ int main(int argc, char **argv)
   /* Общее число процессов в коммуникаторе */
   res = MPI_Comm_size(MPI_COMM_WORLD, &size);
   EXIT_ON_MPI_FAILURE(res);
-  
+
   /* Ранг процесса */
   res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   EXIT_ON_MPI_FAILURE(res);
-  
-  std::cout << "Process " << rank << " Comm size " << size << std::endl;
-
-  int n = (MAX - 1) / (size + 1);
-  
-  unsigned ibeg = rank * n + 1;
-  unsigned iend = (rank + 1) * n;
-  
-  for(unsigned i = ibeg; i <= ((iend > MAX)? MAX : iend); i++) {
-    std::cout << "Process " << rank << ", " << i << "^2 = " << i*i << "\n";
+
+  /* Способ распределения и размер порции: [block|cyclic|dynamic] [<chunk>] */
+  WORK::options opts;
+
+  try {
+
+    if (argc > 1) {
+      opts.kind = WORK::schedule_from_string(argv[1]);
+    }
+
+    if (argc > 2) {
+      opts.chunk = std::stoull(argv[2]);
+    }
+
+    if (opts.chunk == 0) {
+      throw std::invalid_argument("chunk must be positive");
+    }
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " [block|cyclic|dynamic] [<chunk>]\n";
+    }
+
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  /* Вывод процесса накапливается в буфере и печатается процессом 0 одной операцией */
+  std::ostringstream out;
+
+  out << "Process " << rank << " Comm size " << size << "\n";
+
+  WORK::distribute(1, MAX + 1, [&out, rank](uint64_t i) {
+    out << "Process " << rank << ", " << i << "^2 = " << i*i << "\n";
+  }, opts);
+
+  out << "Process " << rank << " finished.\n";
+
+  std::string output = WORK::gather_output(out.str());
+
+  if (rank == 0) {
+    std::cout << output << std::flush;
   }
-    
-  std::cout << "Process " << rank << " finished.\n";
 
   /* Остановка среды MPI */
   res = MPI_Finalize();
   EXIT_ON_MPI_FAILURE(res);
 
   return 0;
-}
\ No newline at end of file
+}
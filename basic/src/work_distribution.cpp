@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "decomposition.hpp"
+#include "task_queue.hpp"
+#include "work_distribution.hpp"
+
+namespace WORK {
+
+schedule schedule_from_string(const std::string& name) {
+
+  if (name == "block") {
+    return schedule::block;
+  } else if (name == "cyclic") {
+    return schedule::cyclic;
+  } else if (name == "dynamic") {
+    return schedule::dynamic;
+  }
+
+  throw std::invalid_argument("unknown schedule " + name);
+}
+
+const char* to_string(schedule kind) {
+
+  switch (kind) {
+    case schedule::block:  return "block";
+    case schedule::cyclic: return "cyclic";
+    default:               return "dynamic";
+  }
+}
+
+static uint64_t handle_range(uint64_t first, uint64_t last, const item_handler& handler) {
+
+  for (uint64_t item = first; item < last; ++item) {
+    handler(item);
+  }
+
+  return last - first;
+}
+
+uint64_t distribute(uint64_t begin, uint64_t end, const item_handler& handler,
+                    const options& opts) {
+
+  if (opts.chunk == 0) {
+    throw std::invalid_argument("chunk must be positive");
+  }
+
+  int size, rank;
+
+  int res = MPI_Comm_size(opts.comm, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(opts.comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  uint64_t total = (end > begin)? end - begin : 0;
+
+  switch (opts.kind) {
+
+    case schedule::block:
+      return handle_range(begin + DECOMP::block_begin(total, size, rank),
+                          begin + DECOMP::block_begin(total, size, rank + 1), handler);
+
+    case schedule::cyclic: {
+
+      uint64_t handled = 0;
+      uint64_t stride = opts.chunk * size;
+
+      for (uint64_t first = begin + opts.chunk * rank; first < begin + total; first += stride) {
+        handled += handle_range(first, std::min(first + opts.chunk, begin + total), handler);
+      }
+
+      return handled;
+    }
+
+    default: {
+
+      /* Master-worker queue of the common library, the items have no results to return */
+      QUEUE::options queue_opts;
+      queue_opts.chunk = opts.chunk;
+      queue_opts.comm  = opts.comm;
+
+      QUEUE::stats work = QUEUE::run(total, 0, [&](uint64_t first, uint64_t last, std::byte*) {
+        handle_range(begin + first, begin + last, handler);
+      }, nullptr, queue_opts);
+
+      return work.tasks;
+    }
+  }
+}
+
+std::string gather_output(const std::string& local, MPI_Comm comm) {
+
+  int size, rank;
+
+  int res = MPI_Comm_size(comm, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  int length = static_cast<int>(local.size());
+
+  std::vector<int> lengths(rank == 0 ? size : 0);
+  res = MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::vector<int> displs(lengths.size());
+  std::string output;
+
+  if (rank == 0) {
+
+    for (int idx = 1; idx < size; ++idx) {
+      displs[idx] = displs[idx - 1] + lengths[idx - 1];
+    }
+
+    output.resize(displs.back() + lengths.back());
+  }
+
+  res = MPI_Gatherv(local.data(), length, MPI_CHAR, output.data(), lengths.data(), displs.data(),
+                    MPI_CHAR, 0, comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  return output;
+}
+
+} // namespace WORK
@@ -0,0 +1,128 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+/* Names of the measurements, see the README for the description */
+inline const std::vector<std::string>& all_tests() {
+
+  static const std::vector<std::string> tests = {
+    "pingpong", "shm", "isend", "sendrecv", "bw", "bibw", "bcast", "reduce", "allreduce", "alltoall"
+  };
+
+  return tests;
+}
+
+/* Run-time parameters of the benchmark */
+struct Bench_options {
+
+  /* Message sizes in bytes, powers of two from 'min_size' to 'max_size' */
+  uint64_t min_size = 1;
+  uint64_t max_size = 64ULL << 20;
+
+  /* Untimed and timed iterations per message size */
+  uint64_t warmup = 10;
+  uint64_t iters = 1000;
+
+  /*
+   * Bytes transferred per message size, the number of timed iterations
+   * of large messages is reduced to fit it, but not below 'Min_iters'
+   */
+  uint64_t volume = 256ULL << 20;
+
+  /* Messages in flight in the bandwidth measurements */
+  uint64_t window = 64;
+
+  /* Measurements to run */
+  std::vector<std::string> tests = all_tests();
+
+  /* CSV file for all measured points, not written if empty */
+  std::string csv;
+};
+
+/* Timed iterations of each size are not reduced below this number */
+static const uint64_t Min_iters = 5;
+
+/* Usage string for the options below */
+inline const char* options_usage() {
+
+  return "[--min-size <bytes>] [--max-size <bytes>] [--warmup <N>] [--iters <N>] "
+         "[--volume <bytes>] [--window <N>] [--tests <name,...>] [--csv <file>]";
+}
+
+/*
+ * Parse command line options given as '--name value' pairs,
+ * options not given keep the values from 'defaults'.
+ * Throws std::invalid_argument on unknown or malformed option.
+ */
+inline Bench_options parse_options(int argc, char** argv,
+                                   const Bench_options& defaults = Bench_options{}) {
+
+  Bench_options options = defaults;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[arg_idx + 1];
+
+    if (name == "--min-size") {
+      options.min_size = std::stoull(value);
+    } else if (name == "--max-size") {
+      options.max_size = std::stoull(value);
+    } else if (name == "--warmup") {
+      options.warmup = std::stoull(value);
+    } else if (name == "--iters") {
+      options.iters = std::stoull(value);
+    } else if (name == "--volume") {
+      options.volume = std::stoull(value);
+    } else if (name == "--window") {
+      options.window = std::stoull(value);
+    } else if (name == "--csv") {
+      options.csv = value;
+    } else if (name == "--tests") {
+
+      options.tests.clear();
+
+      std::istringstream stream(value);
+      std::string test;
+
+      while (std::getline(stream, test, ',')) {
+
+        if (std::find(all_tests().begin(), all_tests().end(), test) == all_tests().end()) {
+          throw std::invalid_argument("unknown test " + test);
+        }
+
+        options.tests.push_back(test);
+      }
+
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.min_size == 0 || options.min_size > options.max_size) {
+    throw std::invalid_argument("sizes must be positive and ordered");
+  }
+
+  if (options.iters == 0 || options.window == 0) {
+    throw std::invalid_argument("iterations and window must be positive");
+  }
+
+  if (options.tests.empty()) {
+    throw std::invalid_argument("no tests given");
+  }
+
+  return options;
+}
+
+#endif // OPTIONS_HPP
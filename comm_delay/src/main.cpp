@@ -1,70 +1,610 @@
+#include <cmath>
+#include <string>
+#include <vector>
 #include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
 
 #include "mpi.h"
 #include "mpi_support.hpp"
+#include "options.hpp"
+#include "shm_mpi.hpp"
+#include "timing.hpp"
 
-static const unsigned Msg_tag = 5U;
+static const int Msg_tag = 5;
+static const int Ack_tag = 6;
 
-void first_process() {
+/* Messages in flight of the bandwidth measurements are limited by this size in bytes */
+static const uint64_t Window_bytes = 64ULL << 20;
 
-  std::cout << "Sending " << NTIMES << " messages there and back again\n";
+/* Alltoall sizes are skipped if the buffer of a process, size per process times processes, exceeds this */
+static const uint64_t Alltoall_bytes = 256ULL << 20;
 
-  double start = MPI_Wtime();
-  std::cout << "Started at: " << start << std::endl;
+/* Time of each timed iteration in seconds */
+using Samples = std::vector<double>;
 
-  for (int msg_cnt = 0; msg_cnt < NTIMES; ++msg_cnt) {
-    
-    int res = MPI_Send(&msg_cnt, 1, MPI_INT, 1, Msg_tag, MPI_COMM_WORLD);
-    EXIT_ON_MPI_FAILURE(res);
+/* One measured message size of a test, times are per message */
+struct Point {
+
+  uint64_t bytes;
+  uint64_t iters;
+
+  double min;
+  double median;
+  double p99;
+
+  /* Megabytes (10^6 bytes) per second */
+  double bandwidth;
+};
+
+/*
+ * Shared memory window of the processes 0 and 1 for the 'shm' test. Segment of each
+ * of them is the number of its messages followed by the message of up to 'max_size' bytes.
+ */
+struct Shm_channel {
+
+  bool available = false;
+
+  MPI_Comm node = MPI_COMM_NULL;
+  MPI_Win win   = MPI_WIN_NULL;
+
+  SHM::counted_segment<char> own;
+  SHM::counted_segment<const char> peer;
+
+  /* Messages sent by the process so far */
+  uint64_t sent = 0;
+};
+
+/* Processes and buffers shared by the tests */
+struct Bench_context {
+
+  int rank;
+  int size;
+
+  const Bench_options& options;
+
+  std::vector<char> send_buf;
+  std::vector<char> recv_buf;
 
-    int payload;
+  Shm_channel shm;
+};
 
-    res = MPI_Recv(&payload, 1, MPI_INT, 1, Msg_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+/*
+ * Collective over MPI_COMM_WORLD. Allocate the window of the 'shm' test on the processes
+ * 0 and 1, it is available on all processes only if these two share memory.
+ */
+static void create_shm_channel(Bench_context& ctx) {
+
+  int res;
+  MPI_Comm pair;
+
+  res = MPI_Comm_split(MPI_COMM_WORLD, (ctx.rank < 2) ? 0 : MPI_UNDEFINED, ctx.rank, &pair);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Shm_channel& shm = ctx.shm;
+
+  if (pair != MPI_COMM_NULL) {
+
+    res = SHM::single_node_comm(pair, &shm.node);
+    EXIT_ON_MPI_FAILURE(res);
+
+    res = MPI_Comm_free(&pair);
     EXIT_ON_MPI_FAILURE(res);
   }
 
-  double finish = MPI_Wtime();
-  std::cout << "Finished at: " << finish << std::endl;
+  int available = (shm.node != MPI_COMM_NULL);
+
+  res = MPI_Bcast(&available, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  shm.available = available;
 
-  std::cout << "Delay per transmission: " << (finish - start) / (2 * NTIMES) << std::endl;
+  if (shm.node == MPI_COMM_NULL) {
+    return;
+  }
+
+  res = SHM::allocate_counted(shm.node, ctx.options.max_size, &shm.win, &shm.own);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = SHM::counted_segment_of(shm.win, 1 - ctx.rank, &shm.peer);
+  EXIT_ON_MPI_FAILURE(res);
 }
 
-void second_process() {
+static void free_shm_channel(Shm_channel& shm) {
 
-  for (int msg_cnt = 0; msg_cnt < NTIMES; ++msg_cnt) {
-    
-    int payload;
+  if (shm.node == MPI_COMM_NULL) {
+    return;
+  }
 
-    int res = MPI_Recv(&payload, 1, MPI_INT, 0, Msg_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    EXIT_ON_MPI_FAILURE(res);
+  int res = SHM::free_window(&shm.win);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_free(&shm.node);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+/* Number of messages in flight of the bandwidth measurements */
+static uint64_t window_for(const Bench_options& options, uint64_t bytes) {
+  return std::clamp<uint64_t>(Window_bytes / bytes, 1, options.window);
+}
+
+/* Number of timed iterations of the size, so that large messages fit the volume */
+static uint64_t iters_for(const Bench_options& options, uint64_t bytes_per_iter) {
+  return std::max(Min_iters, std::min(options.iters, options.volume / bytes_per_iter));
+}
+
+/* Run 'warmup' untimed and 'iters' timed iterations of 'body' */
+template <typename Body>
+static Samples run_iterations(uint64_t warmup, uint64_t iters, Body body) {
+
+  for (uint64_t iter = 0; iter < warmup; ++iter) {
+    body();
+  }
+
+  Samples samples;
+  samples.reserve(iters);
+
+  for (uint64_t iter = 0; iter < iters; ++iter) {
+
+    double start = MPI_Wtime();
+    body();
+    samples.push_back(MPI_Wtime() - start);
+  }
+
+  return samples;
+}
+
+/*
+ * Statistics of the samples divided by 'messages' per iteration,
+ * bandwidth is 'bytes_per_iter' over the median iteration time
+ */
+static Point make_point(Samples samples, uint64_t bytes, uint64_t messages, uint64_t bytes_per_iter) {
+
+  std::sort(samples.begin(), samples.end());
+
+  double median = UTILS::percentile(samples, 0.5);
+
+  return Point{bytes, samples.size(), samples.front() / messages, median / messages,
+               UTILS::percentile(samples, 0.99) / messages, bytes_per_iter / median * 1e-6};
+}
+
+/*
+ * Point-to-point tests between the processes 0 and 1, the others wait.
+ * Returns the point on the process 0.
+ */
+static Point p2p_point(Bench_context& ctx, const std::string& test, uint64_t bytes) {
+
+  int res;
+  int peer = 1 - ctx.rank;
+
+  char* send = ctx.send_buf.data();
+  char* recv = ctx.recv_buf.data();
+
+  uint64_t window = window_for(ctx.options, bytes);
+  std::vector<MPI_Request> requests(2 * window);
+
+  Samples samples;
+
+  if (ctx.rank > 1) {
+    return Point{};
+  }
+
+  if (test == "shm") {
+
+    /*
+     * Round trip through the shared memory: the message is copied from the send buffer
+     * into the own segment and published, the peer waits for it and copies it into
+     * its receive buffer. The own segment is rewritten only after the peer has answered,
+     * so after it has read the previous message.
+     */
+    Shm_channel& shm = ctx.shm;
+
+    auto send_shm = [&]() {
+      std::copy(send, send + bytes, shm.own.data);
+      SHM::publish(*shm.own.cnt, ++shm.sent);
+    };
+
+    auto recv_shm = [&]() {
+      SHM::wait_for(*shm.peer.cnt, shm.sent + (ctx.rank == 1));
+      std::copy(shm.peer.data, shm.peer.data + bytes, recv);
+    };
+
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, 2 * bytes), [&]() {
+
+      if (ctx.rank == 0) {
+        send_shm();
+        recv_shm();
+      } else {
+        recv_shm();
+        send_shm();
+      }
+    });
+
+    return make_point(samples, bytes, 2, 2 * bytes);
+  }
+
+  if (test == "pingpong") {
+
+    /* Round trip of blocking send and receive */
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, 2 * bytes), [&]() {
+
+      if (ctx.rank == 0) {
+
+        res = MPI_Send(send, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD);
+        EXIT_ON_MPI_FAILURE(res);
+
+        res = MPI_Recv(recv, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        EXIT_ON_MPI_FAILURE(res);
+
+      } else {
+
+        res = MPI_Recv(recv, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        EXIT_ON_MPI_FAILURE(res);
+
+        res = MPI_Send(send, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD);
+        EXIT_ON_MPI_FAILURE(res);
+      }
+    });
+
+    return make_point(samples, bytes, 2, 2 * bytes);
+  }
+
+  if (test == "isend") {
+
+    /* Round trip of nonblocking send and receive, receive is posted beforehand */
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, 2 * bytes), [&]() {
+
+      res = MPI_Irecv(recv, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, &requests[0]);
+      EXIT_ON_MPI_FAILURE(res);
+
+      if (ctx.rank == 1) {
+        res = MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+        EXIT_ON_MPI_FAILURE(res);
+      }
+
+      res = MPI_Isend(send, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, &requests[1]);
+      EXIT_ON_MPI_FAILURE(res);
+
+      res = MPI_Waitall(2, requests.data(), MPI_STATUSES_IGNORE);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+    return make_point(samples, bytes, 2, 2 * bytes);
+  }
+
+  if (test == "sendrecv") {
+
+    /* Simultaneous exchange */
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, 2 * bytes), [&]() {
+
+      res = MPI_Sendrecv(send, bytes, MPI_BYTE, peer, Msg_tag,
+                         recv, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+    return make_point(samples, bytes, 1, 2 * bytes);
+  }
+
+  if (test == "bw") {
+
+    /*
+     * Window of messages from 0 to 1 followed by an empty acknowledgement,
+     * send buffer is shared by the messages, receive buffers are distinct
+     */
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, window * bytes), [&]() {
+
+      for (uint64_t msg = 0; msg < window; ++msg) {
+
+        if (ctx.rank == 0) {
+          res = MPI_Isend(send, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, &requests[msg]);
+        } else {
+          res = MPI_Irecv(recv + msg * bytes, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD,
+                          &requests[msg]);
+        }
+
+        EXIT_ON_MPI_FAILURE(res);
+      }
+
+      res = MPI_Waitall(window, requests.data(), MPI_STATUSES_IGNORE);
+      EXIT_ON_MPI_FAILURE(res);
+
+      if (ctx.rank == 0) {
+        res = MPI_Recv(nullptr, 0, MPI_BYTE, peer, Ack_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      } else {
+        res = MPI_Send(nullptr, 0, MPI_BYTE, peer, Ack_tag, MPI_COMM_WORLD);
+      }
 
-    res = MPI_Send(&payload, 1, MPI_INT, 0, Msg_tag, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+    return make_point(samples, bytes, window, window * bytes);
+  }
+
+  /* bibw: windows of messages in both directions at once */
+  samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, 2 * window * bytes), [&]() {
+
+    for (uint64_t msg = 0; msg < window; ++msg) {
+
+      res = MPI_Irecv(recv + msg * bytes, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD,
+                      &requests[msg]);
+      EXIT_ON_MPI_FAILURE(res);
+    }
+
+    for (uint64_t msg = 0; msg < window; ++msg) {
+
+      res = MPI_Isend(send, bytes, MPI_BYTE, peer, Msg_tag, MPI_COMM_WORLD, &requests[window + msg]);
+      EXIT_ON_MPI_FAILURE(res);
+    }
+
+    res = MPI_Waitall(2 * window, requests.data(), MPI_STATUSES_IGNORE);
     EXIT_ON_MPI_FAILURE(res);
+  });
+
+  return make_point(samples, bytes, window, 2 * window * bytes);
+}
+
+/*
+ * Collective tests on all processes. Sample of an iteration is the time
+ * of the slowest process. Returns the point on the process 0.
+ */
+static Point collective_point(Bench_context& ctx, const std::string& test, uint64_t bytes) {
+
+  int res;
+
+  char* send = ctx.send_buf.data();
+  char* recv = ctx.recv_buf.data();
+
+  /* Reductions are done over floats */
+  int count = bytes / sizeof(float);
+
+  std::vector<char> all_send, all_recv;
+  uint64_t iters = iters_for(ctx.options, bytes);
+
+  Samples samples;
+
+  if (test == "bcast") {
+
+    samples = run_iterations(ctx.options.warmup, iters, [&]() {
+      res = MPI_Bcast(send, bytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+  } else if (test == "reduce") {
+
+    samples = run_iterations(ctx.options.warmup, iters, [&]() {
+      res = MPI_Reduce(send, recv, count, MPI_FLOAT, MPI_SUM, 0, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+  } else if (test == "allreduce") {
+
+    samples = run_iterations(ctx.options.warmup, iters, [&]() {
+      res = MPI_Allreduce(send, recv, count, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+
+  } else {
+
+    /* alltoall: 'bytes' to every process */
+    all_send.resize(bytes * ctx.size);
+    all_recv.resize(bytes * ctx.size);
+
+    samples = run_iterations(ctx.options.warmup, iters_for(ctx.options, bytes * ctx.size), [&]() {
+      res = MPI_Alltoall(all_send.data(), bytes, MPI_BYTE,
+                         all_recv.data(), bytes, MPI_BYTE, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+  }
+
+  Samples slowest(ctx.rank == 0 ? samples.size() : 0);
+
+  res = MPI_Reduce(samples.data(), slowest.data(), samples.size(), MPI_DOUBLE, MPI_MAX, 0,
+                   MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (ctx.rank != 0) {
+    return Point{};
+  }
+
+  return make_point(slowest, bytes, 1, (test == "alltoall") ? bytes * ctx.size : bytes);
+}
+
+/*
+ * Hockney model t(n) = latency + n / bandwidth fitted to the median times by least squares
+ * of the relative deviations, so that all sizes of the logarithmic sweep count equally.
+ * Bandwidth is 0 if the times do not grow with the size (flat or noisy sweep),
+ * the latency is the weighted mean time then.
+ */
+static std::pair<double, double> hockney_fit(const std::vector<Point>& points) {
+
+  double s = 0, sn = 0, snn = 0, st = 0, snt = 0;
+
+  for (const Point& point : points) {
+
+    double weight = 1. / (point.median * point.median);
+    double n = point.bytes;
+
+    s   += weight;
+    sn  += weight * n;
+    snn += weight * n * n;
+    st  += weight * point.median;
+    snt += weight * n * point.median;
+  }
+
+  double det = s * snn - sn * sn;
+
+  if (!(det > 0)) {
+    return std::make_pair(st / s, 0.);
+  }
+
+  double latency = (st * snn - sn * snt) / det;
+  double inv_bandwidth = (s * snt - sn * st) / det;
+
+  if (!(inv_bandwidth > 0)) {
+    return std::make_pair(st / s, 0.);
   }
+
+  return std::make_pair(latency, 1e-6 / inv_bandwidth);
+}
+
+static bool is_p2p(const std::string& test) {
+  return test == "shm" || test == "pingpong" || test == "isend" || test == "sendrecv" || test == "bw" || test == "bibw";
 }
 
 int main(int argc, char **argv)
 {
-  int res, rank;
+  int res, rank, size;
 
   /* Инициализация среды MPI */
   res = MPI_Init(&argc, &argv);
   EXIT_ON_MPI_FAILURE(res);
-  
+
+  /* Общее число процессов в коммуникаторе */
+  res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
   /* Ранг процесса */
   res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   EXIT_ON_MPI_FAILURE(res);
-  
+
+  Bench_options options;
+
+  try {
+
+    options = parse_options(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    }
+
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  /* Размеры сообщений - степени двойки от min_size до max_size */
+  std::vector<uint64_t> sizes;
+  for (uint64_t bytes = options.min_size; bytes <= options.max_size; bytes *= 2) {
+    sizes.push_back(bytes);
+  }
+
+  /* Буфер приёма вмещает окно сообщений измерения пропускной способности */
+  uint64_t recv_bytes = 0;
+  for (uint64_t bytes : sizes) {
+    recv_bytes = std::max(recv_bytes, bytes * window_for(options, bytes));
+  }
+
+  Bench_context ctx{rank, size, options, std::vector<char>(options.max_size),
+                    std::vector<char>(recv_bytes), Shm_channel{}};
+
+  if (size >= 2 && std::find(options.tests.begin(), options.tests.end(), "shm") != options.tests.end()) {
+    create_shm_channel(ctx);
+  }
+
+  std::ofstream csv;
+
   if (rank == 0) {
-    first_process();
-  } else {
-    second_process();
+
+    std::cout << "Processes: " << size << ", warm-up iterations: " << options.warmup
+              << ", timed iterations: up to " << options.iters << "\n";
+
+    if (!options.csv.empty()) {
+
+      csv.open(options.csv);
+      csv << "test,bytes,procs,iterations,min_us,median_us,p99_us,bandwidth_MBps\n";
+    }
+  }
+
+  for (const std::string& test : options.tests) {
+
+    bool p2p = is_p2p(test);
+
+    if (p2p && size < 2) {
+
+      if (rank == 0) {
+        std::cout << "\n# " << test << ": skipped, requires at least 2 processes\n";
+      }
+
+      continue;
+    }
+
+    if (test == "shm" && !ctx.shm.available) {
+
+      if (rank == 0) {
+        std::cout << "\n# " << test << ": skipped, processes 0 and 1 do not share memory\n";
+      }
+
+      continue;
+    }
+
+    if (rank == 0) {
+
+      std::cout << "\n# " << test << (p2p ? " (processes 0 and 1)" : " (all processes)") << "\n";
+      std::cout << std::setw(10) << "bytes" << std::setw(8) << "iters" << std::setw(14) << "min, us"
+                << std::setw(14) << "median, us" << std::setw(14) << "p99, us"
+                << std::setw(14) << "MB/s" << "\n";
+    }
+
+    std::vector<Point> points;
+
+    for (uint64_t bytes : sizes) {
+
+      /* Reductions are done over floats, alltoall buffers are limited */
+      if ((test == "reduce" || test == "allreduce") && bytes < sizeof(float)) {
+        continue;
+      }
+
+      if (test == "alltoall" && bytes * size > Alltoall_bytes) {
+        continue;
+      }
+
+      res = MPI_Barrier(MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+
+      Point point = p2p ? p2p_point(ctx, test, bytes) : collective_point(ctx, test, bytes);
+
+      if (rank != 0) {
+        continue;
+      }
+
+      points.push_back(point);
+
+      std::cout << std::setw(10) << point.bytes << std::setw(8) << point.iters << std::fixed
+                << std::setprecision(3) << std::setw(14) << point.min * 1e6
+                << std::setw(14) << point.median * 1e6 << std::setw(14) << point.p99 * 1e6
+                << std::setprecision(1) << std::setw(14) << point.bandwidth
+                << std::defaultfloat << std::endl;
+
+      if (csv.is_open()) {
+        csv << test << "," << point.bytes << "," << size << "," << point.iters << ","
+            << point.min * 1e6 << "," << point.median * 1e6 << "," << point.p99 * 1e6 << ","
+            << point.bandwidth << "\n";
+      }
+    }
+
+    if (rank == 0 && p2p && points.size() > 1) {
+
+      auto [latency, bandwidth] = hockney_fit(points);
+      std::cout << std::setprecision(4) << "Hockney fit: latency " << latency * 1e6 << " us, ";
+
+      if (bandwidth > 0) {
+        std::cout << "bandwidth " << bandwidth << " MB/s\n";
+      } else {
+        std::cout << "bandwidth n/a\n";
+      }
+    }
   }
 
+  free_shm_channel(ctx.shm);
+
   /* Остановка среды MPI */
   res = MPI_Finalize();
   EXIT_ON_MPI_FAILURE(res);
 
   return 0;
-}
\ No newline at end of file
+}
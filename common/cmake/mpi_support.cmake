@@ -0,0 +1,10 @@
+# MPI support library shared by the MPI projects, see common/inc/mpi_support.hpp.
+# Projects include this file after setting the MPI compiler and link the 'mpi_support' target:
+#   include(../common/cmake/mpi_support.cmake)
+#   target_link_libraries(<target> PRIVATE mpi_support)
+
+if(NOT TARGET mpi_support)
+  add_library(mpi_support STATIC ${CMAKE_CURRENT_LIST_DIR}/../src/mpi_support.cpp)
+  target_include_directories(mpi_support PUBLIC ${CMAKE_CURRENT_LIST_DIR}/../inc)
+  target_compile_features(mpi_support PUBLIC cxx_std_20)
+endif()
@@ -0,0 +1,12 @@
+# Master-worker task queue shared by the MPI projects, see common/inc/task_queue.hpp.
+# Projects include this file after setting the MPI compiler and link the 'task_queue' target:
+#   include(../common/cmake/task_queue.cmake)
+#   target_link_libraries(<target> PRIVATE task_queue)
+
+include(${CMAKE_CURRENT_LIST_DIR}/mpi_support.cmake)
+
+if(NOT TARGET task_queue)
+  add_library(task_queue STATIC ${CMAKE_CURRENT_LIST_DIR}/../src/task_queue.cpp)
+  target_include_directories(task_queue PUBLIC ${CMAKE_CURRENT_LIST_DIR}/../inc)
+  target_link_libraries(task_queue PUBLIC mpi_support)
+endif()
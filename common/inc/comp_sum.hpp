@@ -0,0 +1,55 @@
+#ifndef COMP_SUM_HPP
+#define COMP_SUM_HPP
+
+#include <cmath>
+#include <type_traits>
+
+namespace UTILS
+{
+
+/*
+ * Sum with the compensation term (Neumaier's variant of the Kahan summation):
+ * the exact value of the sum is approximately 'sum + comp', 'comp' keeps
+ * the low-order bits lost when adding terms to 'sum'. Two values of T
+ * without padding, so that the sums are sent as 2 elements of the MPI type of T.
+ */
+template <typename T>
+struct comp_sum
+{
+  static_assert(std::is_floating_point_v<T>, "compensated sum of floating-point values");
+
+  T sum  = 0;
+  T comp = 0;
+
+  void add(T value)
+  {
+    T new_sum = sum + value;
+
+    if (std::abs(sum) >= std::abs(value))
+    {
+      comp += (sum - new_sum) + value;
+    }
+    else
+    {
+      comp += (value - new_sum) + sum;
+    }
+
+    sum = new_sum;
+  }
+
+  /* Add the other compensated sum: error of adding the sums goes to the compensation */
+  void merge(const comp_sum& other)
+  {
+    add(other.sum);
+    comp += other.comp;
+  }
+
+  T value() const
+  {
+    return sum + comp;
+  }
+};
+
+} // namespace UTILS
+
+#endif // COMP_SUM_HPP
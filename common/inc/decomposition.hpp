@@ -0,0 +1,213 @@
+#ifndef DECOMPOSITION_HPP
+#define DECOMPOSITION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DECOMP
+{
+
+/*
+ * Decomposition of 'total' consecutive items (grid points, rows) into
+ * blocks, one block per executor. Block 'idx' is [offsets[idx]; offsets[idx + 1]).
+ */
+using offsets = std::vector<uint64_t>;
+
+/* First item of the block 'idx', remainder items are spread over the first blocks. */
+constexpr uint64_t block_begin(uint64_t total, uint64_t parts, uint64_t idx)
+{
+  return (total / parts) * idx + std::min(idx, total % parts);
+}
+
+/* Even decomposition, block sizes differ at most by one. */
+inline offsets even_offsets(uint64_t total, uint64_t parts)
+{
+  offsets result(parts + 1);
+
+  for (uint64_t idx = 0; idx <= parts; ++idx)
+  {
+    result[idx] = block_begin(total, parts, idx);
+  }
+
+  return result;
+}
+
+/* Equal weights, which give the even decomposition. */
+inline std::vector<double> even_weights(uint64_t parts)
+{
+  return std::vector<double>(parts, 1.);
+}
+
+/*
+ * Decomposition with block sizes proportional to the weights of the executors.
+ * Every block gets at least 'min_block' items, the rest is split with
+ * the largest remainder method, so that equal weights give the even decomposition.
+ * Throws std::invalid_argument if the items are too few or weights are not positive.
+ */
+inline offsets weighted_offsets(uint64_t total, const std::vector<double>& weights,
+                                uint64_t min_block = 0)
+{
+  uint64_t parts = weights.size();
+
+  if (parts == 0 || total < parts * min_block)
+  {
+    throw std::invalid_argument("too few items to decompose");
+  }
+
+  for (double weight : weights)
+  {
+    if (!(weight > 0) || !std::isfinite(weight))
+    {
+      throw std::invalid_argument("weights must be positive");
+    }
+  }
+
+  uint64_t spare = total - parts * min_block;
+  double weight_sum = std::accumulate(weights.begin(), weights.end(), 0.);
+
+  std::vector<uint64_t> sizes(parts);
+  std::vector<double> fraction(parts);
+  uint64_t assigned = 0;
+
+  for (uint64_t idx = 0; idx < parts; ++idx)
+  {
+    double quota = spare * (weights[idx] / weight_sum);
+    double whole = std::floor(quota);
+
+    sizes[idx] = std::min(static_cast<uint64_t>(whole), spare - assigned);
+    fraction[idx] = quota - whole;
+    assigned += sizes[idx];
+  }
+
+  /* Items left after rounding down go to the blocks with the largest fractions. */
+  std::vector<uint64_t> order(parts);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&fraction](uint64_t lhs, uint64_t rhs) { return fraction[lhs] > fraction[rhs]; });
+
+  for (uint64_t idx = 0; assigned < spare; idx = (idx + 1) % parts)
+  {
+    ++sizes[order[idx]];
+    ++assigned;
+  }
+
+  offsets result(parts + 1);
+  result[0] = 0;
+
+  for (uint64_t idx = 0; idx < parts; ++idx)
+  {
+    result[idx + 1] = result[idx] + min_block + sizes[idx];
+  }
+
+  return result;
+}
+
+/*
+ * Weights for the next run from the time each executor spent on its block.
+ * Speed of the executor is the size of its block divided by its time.
+ * 'relaxation' in (0; 1] mixes new speeds with the old weights to damp
+ * the noise of measurements, 1 uses the measured speeds only.
+ * Executors without measurements keep their weights. Result is normalized
+ * to the mean of 1.
+ */
+inline std::vector<double> rebalance(const offsets& offs, const std::vector<double>& times,
+                                     const std::vector<double>& weights, double relaxation = 0.5)
+{
+  uint64_t parts = weights.size();
+
+  double weight_sum = std::accumulate(weights.begin(), weights.end(), 0.);
+
+  std::vector<double> speed(parts, 0.);
+  double speed_sum = 0, measured_weight = 0;
+
+  for (uint64_t idx = 0; idx < parts; ++idx)
+  {
+    uint64_t items = offs[idx + 1] - offs[idx];
+
+    if (items != 0 && times[idx] > 0)
+    {
+      speed[idx] = items / times[idx];
+      speed_sum += speed[idx];
+      measured_weight += weights[idx] / weight_sum;
+    }
+  }
+
+  std::vector<double> result(parts);
+
+  for (uint64_t idx = 0; idx < parts; ++idx)
+  {
+    double old_weight = weights[idx] / weight_sum;
+
+    /* Measured speeds replace the share of the measured executors only. */
+    double new_weight = (speed[idx] > 0) ? measured_weight * speed[idx] / speed_sum : old_weight;
+
+    result[idx] = (1 - relaxation) * old_weight + relaxation * new_weight;
+  }
+
+  double result_sum = std::accumulate(result.begin(), result.end(), 0.);
+
+  for (double& weight : result)
+  {
+    weight *= parts / result_sum;
+  }
+
+  return result;
+}
+
+/*
+ * Weights are kept between runs in a text file, one weight per line.
+ * Missing file or file written for a different number of executors
+ * gives the even weights.
+ */
+inline std::vector<double> load_weights(const std::string& path, uint64_t parts)
+{
+  std::ifstream input(path);
+
+  std::vector<double> result;
+  double weight;
+
+  while (input >> weight)
+  {
+    result.push_back(weight);
+  }
+
+  bool valid = result.size() == parts
+               && std::all_of(result.begin(), result.end(),
+                              [](double value) { return value > 0 && std::isfinite(value); });
+
+  return valid ? result : even_weights(parts);
+}
+
+/* Returns false if the file cannot be written. */
+inline bool save_weights(const std::string& path, const std::vector<double>& weights)
+{
+  std::ofstream output(path);
+
+  output.precision(17);
+
+  for (double weight : weights)
+  {
+    output << weight << '\n';
+  }
+
+  return static_cast<bool>(output);
+}
+
+/* Ratio of the longest time to the mean one, 1 for the perfect balance. */
+inline double imbalance(const std::vector<double>& times)
+{
+  double mean = std::accumulate(times.begin(), times.end(), 0.) / times.size();
+  double max = *std::max_element(times.begin(), times.end());
+
+  return (mean > 0) ? max / mean : 1.;
+}
+
+} /* namespace DECOMP */
+
+#endif /* DECOMPOSITION_HPP */
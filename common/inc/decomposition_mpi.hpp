@@ -0,0 +1,75 @@
+#ifndef DECOMPOSITION_MPI_HPP
+#define DECOMPOSITION_MPI_HPP
+
+#include <string>
+#include <vector>
+
+#include "mpi.h"
+
+#include "decomposition.hpp"
+
+namespace DECOMP
+{
+
+/*
+ * Load balancing between runs of the MPI programs.
+ * All functions are collective and return MPI error code, so that
+ * the caller can handle it the same way as the rest of MPI calls.
+ */
+
+/*
+ * Rank 0 loads the weights of all ranks from 'path' and broadcasts them.
+ * Empty path gives the even weights.
+ */
+inline int mpi_load_weights(MPI_Comm comm, const std::string& path, std::vector<double>& weights)
+{
+  int size, rank;
+
+  int res = MPI_Comm_size(comm, &size);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  res = MPI_Comm_rank(comm, &rank);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  weights = (rank == 0 && !path.empty()) ? load_weights(path, size) : even_weights(size);
+
+  return MPI_Bcast(weights.data(), size, MPI_DOUBLE, 0, comm);
+}
+
+/*
+ * Gather time spent by each rank on its block on rank 0.
+ * Rank 0 computes the weights for the next run and saves them into 'path'
+ * unless it is empty, 'times' are filled on rank 0 and left empty on the others.
+ */
+inline int mpi_rebalance(MPI_Comm comm, const std::string& path, const offsets& offs,
+                         const std::vector<double>& weights, double local_time,
+                         std::vector<double>& times, double relaxation = 0.5)
+{
+  int rank;
+
+  int res = MPI_Comm_rank(comm, &rank);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  times.resize((rank == 0) ? weights.size() : 0);
+
+  res = MPI_Gather(&local_time, 1, MPI_DOUBLE, times.data(), 1, MPI_DOUBLE, 0, comm);
+  if (res != MPI_SUCCESS || rank != 0 || path.empty())
+  {
+    return res;
+  }
+
+  return save_weights(path, rebalance(offs, times, weights, relaxation)) ? MPI_SUCCESS : MPI_ERR_IO;
+}
+
+} /* namespace DECOMP */
+
+#endif /* DECOMPOSITION_MPI_HPP */
@@ -0,0 +1,106 @@
+#ifndef FIELD_FORMAT_HPP
+#define FIELD_FORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace FIELD
+{
+
+/*
+ * Binary format of the solution fields.
+ *
+ * File consists of the fixed-size header followed by the values
+ * stored in row-major order in the native byte order. One-dimensional
+ * fields are stored as a single row.
+ */
+
+/* Type of the stored values. */
+enum class dtype : uint32_t
+{
+  float64 = 1,
+};
+
+/* Size in bytes of the value of the given type. */
+constexpr uint64_t dtype_size(dtype type)
+{
+  switch (type)
+  {
+    case dtype::float64:
+      return sizeof(double);
+  }
+
+  return 0;
+}
+
+constexpr char Magic[8] = "PPFIELD";
+constexpr uint32_t Version = 1;
+
+struct header
+{
+  char magic[8];
+  uint32_t version;
+  dtype type;
+
+  /* Number of dimensions, either 1 or 2. */
+  uint32_t ndims;
+  uint32_t reserved;
+
+  /* Number of rows and columns, rows = 1 for one-dimensional fields. */
+  uint64_t dims[2];
+
+  /* Grid spacing along the rows and the columns. */
+  double spacing[2];
+};
+
+static_assert(sizeof(header) == 56, "Field header layout must not depend on the platform");
+
+/* Offset of the first value in the file. */
+constexpr uint64_t Data_offset = sizeof(header);
+
+/* Header of the one-dimensional field of 'points' values with grid step 'step'. */
+inline header make_header_1d(uint64_t points, double step)
+{
+  header hdr{};
+  std::memcpy(hdr.magic, Magic, sizeof(Magic));
+  hdr.version = Version;
+  hdr.type = dtype::float64;
+  hdr.ndims = 1;
+  hdr.dims[0] = 1;
+  hdr.dims[1] = points;
+  hdr.spacing[0] = 0;
+  hdr.spacing[1] = step;
+  return hdr;
+}
+
+/* Header of the two-dimensional field 'rows' x 'cols' with grid steps 'row_step' and 'col_step'. */
+inline header make_header_2d(uint64_t rows, uint64_t cols, double row_step = 1, double col_step = 1)
+{
+  header hdr{};
+  std::memcpy(hdr.magic, Magic, sizeof(Magic));
+  hdr.version = Version;
+  hdr.type = dtype::float64;
+  hdr.ndims = 2;
+  hdr.dims[0] = rows;
+  hdr.dims[1] = cols;
+  hdr.spacing[0] = row_step;
+  hdr.spacing[1] = col_step;
+  return hdr;
+}
+
+/* Checks that the header was produced by a compatible writer. */
+inline bool is_valid(const header& hdr)
+{
+  return std::memcmp(hdr.magic, Magic, sizeof(Magic)) == 0 && hdr.version == Version
+         && dtype_size(hdr.type) != 0 && (hdr.ndims == 1 || hdr.ndims == 2);
+}
+
+/* Total size of the file in bytes. */
+inline uint64_t file_size(const header& hdr)
+{
+  return Data_offset + hdr.dims[0] * hdr.dims[1] * dtype_size(hdr.type);
+}
+
+} /* namespace FIELD */
+
+#endif /* FIELD_FORMAT_HPP */
@@ -0,0 +1,84 @@
+#ifndef FIELD_MMAP_HPP
+#define FIELD_MMAP_HPP
+
+#include <string>
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "field_format.hpp"
+
+namespace FIELD
+{
+
+/*
+ * Field file mapped into memory for writing.
+ * File is created (or truncated) with the size given by the header,
+ * the header is written on construction and the values are
+ * accessed directly through the mapping, so rows can be stored
+ * in parallel without any intermediate buffering.
+ */
+class mapped_writer
+{
+  header header_;
+
+  int fd_ = -1;
+  void* map_ = MAP_FAILED;
+  uint64_t size_ = 0;
+
+public:
+  /* Throws std::system_error if the file cannot be created or mapped. */
+  mapped_writer(const std::string& path, const header& hdr) : header_(hdr), size_(file_size(hdr))
+  {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0)
+    {
+      int err = errno;
+      ::close(fd_);
+      throw std::system_error(err, std::generic_category(), "ftruncate " + path);
+    }
+
+    map_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED)
+    {
+      int err = errno;
+      ::close(fd_);
+      throw std::system_error(err, std::generic_category(), "mmap " + path);
+    }
+
+    std::memcpy(map_, &header_, sizeof(header_));
+  }
+
+  mapped_writer(const mapped_writer&) = delete;
+  mapped_writer& operator=(const mapped_writer&) = delete;
+
+  /* Unmaps the file, dirty pages are written back by the kernel. */
+  ~mapped_writer()
+  {
+    ::munmap(map_, size_);
+    ::close(fd_);
+  }
+
+  /* Pointer to the first value of the row. */
+  double* row(uint64_t idx)
+  {
+    return reinterpret_cast<double*>(static_cast<char*>(map_) + Data_offset) + idx * header_.dims[1];
+  }
+
+  const header& get_header() const
+  {
+    return header_;
+  }
+};
+
+} /* namespace FIELD */
+
+#endif /* FIELD_MMAP_HPP */
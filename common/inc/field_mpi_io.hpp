@@ -0,0 +1,113 @@
+#ifndef FIELD_MPI_IO_HPP
+#define FIELD_MPI_IO_HPP
+
+#include <climits>
+
+#include "mpi.h"
+
+#include "field_format.hpp"
+
+namespace FIELD
+{
+
+/*
+ * Collective output of the field with MPI-IO.
+ * All functions return MPI error code, so that the caller
+ * can handle it the same way as the rest of MPI calls.
+ */
+
+/* Collectively create the file, rank 0 of the communicator writes the header. */
+inline int mpi_create(MPI_Comm comm, const char* path, const header& hdr, MPI_File* fh)
+{
+  int res = MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, fh);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  /* Drop contents left from the previous runs. */
+  res = MPI_File_set_size(*fh, static_cast<MPI_Offset>(file_size(hdr)));
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  int rank;
+  res = MPI_Comm_rank(comm, &rank);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  if (rank == 0)
+  {
+    res = MPI_File_write_at(*fh, 0, &hdr, sizeof(hdr), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+
+  return res;
+}
+
+/*
+ * Collectively write 'count' elements of 'type' from 'buf' starting from
+ * the value with linear index 'first' (row-major). Element type may be
+ * a derived datatype describing strided values in memory.
+ */
+inline int mpi_write_all(MPI_File fh, uint64_t first, const void* buf, int count, MPI_Datatype type)
+{
+  MPI_Offset offset = static_cast<MPI_Offset>(Data_offset + first * sizeof(double));
+  return MPI_File_write_at_all(fh, offset, buf, count, type, MPI_STATUS_IGNORE);
+}
+
+/*
+ * Collectively write the block [row_begin; row_begin + rows) x [col_begin; col_begin + cols)
+ * of the two-dimensional field. Values of the block are described in memory
+ * by a single element of 'type', e.g. a subarray of the array with halo.
+ * Subarray type takes int sizes, MPI_ERR_ARG is returned before any I/O
+ * if the field dimensions exceed INT_MAX or the block is outside of the field.
+ */
+inline int mpi_write_block_all(MPI_File fh, const header& hdr, uint64_t row_begin, uint64_t rows,
+                               uint64_t col_begin, uint64_t cols, const void* buf, MPI_Datatype type)
+{
+  if (hdr.dims[0] > INT_MAX || hdr.dims[1] > INT_MAX
+      || row_begin > hdr.dims[0] || rows > hdr.dims[0] - row_begin
+      || col_begin > hdr.dims[1] || cols > hdr.dims[1] - col_begin)
+  {
+    return MPI_ERR_ARG;
+  }
+
+  int sizes[2] = {static_cast<int>(hdr.dims[0]), static_cast<int>(hdr.dims[1])};
+  int subsizes[2] = {static_cast<int>(rows), static_cast<int>(cols)};
+  int starts[2] = {static_cast<int>(row_begin), static_cast<int>(col_begin)};
+
+  MPI_Datatype block;
+  int res = MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &block);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  res = MPI_Type_commit(&block);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  res = MPI_File_set_view(fh, static_cast<MPI_Offset>(Data_offset), MPI_DOUBLE, block, "native",
+                          MPI_INFO_NULL);
+  if (res == MPI_SUCCESS)
+  {
+    res = MPI_File_write_all(fh, buf, (rows * cols != 0) ? 1 : 0, type, MPI_STATUS_IGNORE);
+  }
+
+  int free_res = MPI_Type_free(&block);
+  return (res != MPI_SUCCESS) ? res : free_res;
+}
+
+inline int mpi_close(MPI_File* fh)
+{
+  return MPI_File_close(fh);
+}
+
+} /* namespace FIELD */
+
+#endif /* FIELD_MPI_IO_HPP */
@@ -0,0 +1,332 @@
+#ifndef MPI_SUPPORT_HPP
+#define MPI_SUPPORT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <ranges>
+#include <source_location>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "mpi.h"
+
+/*
+ * MPI support library shared by the MPI projects of the repository:
+ * - error handling: MPI::exit_on_mpi_failure and the EXIT_ON_MPI_FAILURE macro;
+ * - RAII environment (MPI::MPI_env) and request handles (MPI::request);
+ * - typed point-to-point operations deducing MPI_Datatype from C++ types;
+ * - persistent requests for the exchanges repeated every step.
+ * Build target 'mpi_support' is defined by 'common/cmake/mpi_support.cmake'.
+ */
+
+namespace MPI
+{
+
+constexpr int Msg_tag = 42;
+
+class stopwatch
+{
+  using time_point_t = double;
+  time_point_t start_;
+
+public:
+  /* Starts stopwatch. */
+  void start()
+  {
+    start_ = MPI_Wtime();
+  }
+
+  /* Stopts stopwatch and returns elapsed time in seconds. */
+  double stop() const
+  {
+    time_point_t stop = MPI_Wtime();
+    return stop - start_;
+  }
+};
+
+/* Prints the location and the MPI error, finalizes MPI and exits if 'res' is not MPI_SUCCESS. */
+void exit_on_mpi_failure(
+  const int res,
+  const std::source_location& sloc = std::source_location::current());
+
+/*
+ * MPI environment of the program lifetime. The threaded constructor requests
+ * the thread support level, the provided one is returned by 'provided()'.
+ */
+class MPI_env
+{
+  int provided_ = MPI_THREAD_SINGLE;
+
+public:
+  MPI_env(int& argc, char**& argv);
+  MPI_env(int& argc, char**& argv, int required);
+
+  MPI_env(const MPI_env&) = delete;
+  MPI_env& operator=(const MPI_env&) = delete;
+
+  ~MPI_env();
+
+  int provided() const
+  {
+    return provided_;
+  }
+};
+
+/*
+ * Predefined datatypes of the C++ types. Types without the specialization
+ * are not accepted by the typed operations below, use the MPI calls with
+ * the derived datatypes for them.
+ */
+template <typename T>
+struct datatype_traits;
+
+#define MPI_SUPPORT_DATATYPE(TYPE, MPI_TYPE)  \
+  template <>                                 \
+  struct datatype_traits<TYPE>                \
+  {                                           \
+    static MPI_Datatype get()                 \
+    {                                         \
+      return MPI_TYPE;                        \
+    }                                         \
+  };
+
+MPI_SUPPORT_DATATYPE(char, MPI_CHAR)
+MPI_SUPPORT_DATATYPE(signed char, MPI_SIGNED_CHAR)
+MPI_SUPPORT_DATATYPE(unsigned char, MPI_UNSIGNED_CHAR)
+MPI_SUPPORT_DATATYPE(std::byte, MPI_BYTE)
+MPI_SUPPORT_DATATYPE(bool, MPI_CXX_BOOL)
+MPI_SUPPORT_DATATYPE(short, MPI_SHORT)
+MPI_SUPPORT_DATATYPE(unsigned short, MPI_UNSIGNED_SHORT)
+MPI_SUPPORT_DATATYPE(int, MPI_INT)
+MPI_SUPPORT_DATATYPE(unsigned, MPI_UNSIGNED)
+MPI_SUPPORT_DATATYPE(long, MPI_LONG)
+MPI_SUPPORT_DATATYPE(unsigned long, MPI_UNSIGNED_LONG)
+MPI_SUPPORT_DATATYPE(long long, MPI_LONG_LONG)
+MPI_SUPPORT_DATATYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG)
+MPI_SUPPORT_DATATYPE(float, MPI_FLOAT)
+MPI_SUPPORT_DATATYPE(double, MPI_DOUBLE)
+MPI_SUPPORT_DATATYPE(long double, MPI_LONG_DOUBLE)
+MPI_SUPPORT_DATATYPE(std::complex<float>, MPI_CXX_FLOAT_COMPLEX)
+MPI_SUPPORT_DATATYPE(std::complex<double>, MPI_CXX_DOUBLE_COMPLEX)
+
+#undef MPI_SUPPORT_DATATYPE
+
+template <typename T>
+concept predefined = requires { datatype_traits<std::remove_cv_t<T>>::get(); };
+
+template <typename T>
+MPI_Datatype datatype()
+{
+  return datatype_traits<std::remove_cv_t<T>>::get();
+}
+
+/*
+ * Message buffer: a single value of the predefined type or a contiguous range
+ * of them (std::span, std::vector, std::array, C array). Counts are int, larger
+ * messages have to be sent as elements of a contiguous derived datatype.
+ */
+template <typename B>
+concept buffer = predefined<std::remove_reference_t<B>> ||
+  (std::ranges::contiguous_range<B> && std::ranges::sized_range<B> &&
+   predefined<std::ranges::range_value_t<B>>);
+
+namespace detail
+{
+
+template <typename B>
+auto* data(B&& buf)
+{
+  if constexpr (predefined<std::remove_reference_t<B>>)
+    return &buf;
+  else
+    return std::ranges::data(buf);
+}
+
+template <typename B>
+int count(B&& buf)
+{
+  if constexpr (predefined<std::remove_reference_t<B>>)
+    return 1;
+  else
+    return static_cast<int>(std::ranges::size(buf));
+}
+
+template <typename B>
+MPI_Datatype type()
+{
+  if constexpr (predefined<std::remove_reference_t<B>>)
+    return datatype<std::remove_reference_t<B>>();
+  else
+    return datatype<std::ranges::range_value_t<B>>();
+}
+
+} /* namespace detail */
+
+/*
+ * Owning handle of a nonblocking or persistent request. Destructor completes
+ * the operation in flight, so that its buffer is not released under it,
+ * and frees the persistent request.
+ */
+class request
+{
+  MPI_Request req_ = MPI_REQUEST_NULL;
+  bool persistent_ = false;
+
+public:
+  request() = default;
+
+  request(MPI_Request req, bool persistent)
+    : req_(req), persistent_(persistent)
+  {}
+
+  request(request&& other) noexcept
+    : req_(std::exchange(other.req_, MPI_REQUEST_NULL)),
+      persistent_(std::exchange(other.persistent_, false))
+  {}
+
+  request& operator=(request&& other) noexcept
+  {
+    if (this != &other)
+    {
+      release();
+      req_ = std::exchange(other.req_, MPI_REQUEST_NULL);
+      persistent_ = std::exchange(other.persistent_, false);
+    }
+    return *this;
+  }
+
+  request(const request&) = delete;
+  request& operator=(const request&) = delete;
+
+  ~request()
+  {
+    release();
+  }
+
+  /* Start the persistent request. */
+  void start(const std::source_location& sloc = std::source_location::current())
+  {
+    exit_on_mpi_failure(MPI_Start(&req_), sloc);
+  }
+
+  MPI_Status wait(const std::source_location& sloc = std::source_location::current())
+  {
+    MPI_Status status;
+    exit_on_mpi_failure(MPI_Wait(&req_, &status), sloc);
+    return status;
+  }
+
+  bool test(const std::source_location& sloc = std::source_location::current())
+  {
+    int done;
+    exit_on_mpi_failure(MPI_Test(&req_, &done, MPI_STATUS_IGNORE), sloc);
+    return done;
+  }
+
+  MPI_Request& native()
+  {
+    return req_;
+  }
+
+  bool persistent() const
+  {
+    return persistent_;
+  }
+
+private:
+  void release();
+};
+
+/* Complete all requests with one MPI_Waitall. */
+void wait_all(std::span<request> requests,
+              const std::source_location& sloc = std::source_location::current());
+
+/* Start all persistent requests with one MPI_Startall. */
+void start_all(std::span<request> requests,
+               const std::source_location& sloc = std::source_location::current());
+
+/* Typed point-to-point operations, 'source' and 'dest' may be MPI_PROC_NULL. */
+
+template <buffer B>
+void send(const B& buf, int dest, int tag = Msg_tag, MPI_Comm comm = MPI_COMM_WORLD,
+          const std::source_location& sloc = std::source_location::current())
+{
+  exit_on_mpi_failure(
+    MPI_Send(detail::data(buf), detail::count(buf), detail::type<const B&>(), dest, tag, comm),
+    sloc);
+}
+
+template <buffer B>
+MPI_Status recv(B&& buf, int source, int tag = Msg_tag, MPI_Comm comm = MPI_COMM_WORLD,
+                const std::source_location& sloc = std::source_location::current())
+{
+  MPI_Status status;
+  exit_on_mpi_failure(
+    MPI_Recv(detail::data(buf), detail::count(buf), detail::type<B>(), source, tag, comm, &status),
+    sloc);
+  return status;
+}
+
+template <buffer B>
+[[nodiscard]] request isend(const B& buf, int dest, int tag = Msg_tag,
+                            MPI_Comm comm = MPI_COMM_WORLD,
+                            const std::source_location& sloc = std::source_location::current())
+{
+  MPI_Request req;
+  exit_on_mpi_failure(
+    MPI_Isend(detail::data(buf), detail::count(buf), detail::type<const B&>(), dest, tag, comm,
+              &req),
+    sloc);
+  return request(req, false);
+}
+
+template <buffer B>
+[[nodiscard]] request irecv(B&& buf, int source, int tag = Msg_tag,
+                            MPI_Comm comm = MPI_COMM_WORLD,
+                            const std::source_location& sloc = std::source_location::current())
+{
+  MPI_Request req;
+  exit_on_mpi_failure(
+    MPI_Irecv(detail::data(buf), detail::count(buf), detail::type<B>(), source, tag, comm, &req),
+    sloc);
+  return request(req, false);
+}
+
+/*
+ * Persistent requests: the arguments are bound once, every 'start' repeats the operation
+ * without matching the arguments again. The buffers must outlive the request.
+ */
+
+template <buffer B>
+[[nodiscard]] request send_init(const B& buf, int dest, int tag = Msg_tag,
+                                MPI_Comm comm = MPI_COMM_WORLD,
+                                const std::source_location& sloc = std::source_location::current())
+{
+  MPI_Request req;
+  exit_on_mpi_failure(
+    MPI_Send_init(detail::data(buf), detail::count(buf), detail::type<const B&>(), dest, tag, comm,
+                  &req),
+    sloc);
+  return request(req, true);
+}
+
+template <buffer B>
+[[nodiscard]] request recv_init(B&& buf, int source, int tag = Msg_tag,
+                                MPI_Comm comm = MPI_COMM_WORLD,
+                                const std::source_location& sloc = std::source_location::current())
+{
+  MPI_Request req;
+  exit_on_mpi_failure(
+    MPI_Recv_init(detail::data(buf), detail::count(buf), detail::type<B>(), source, tag, comm,
+                  &req),
+    sloc);
+  return request(req, true);
+}
+
+} /* namespace MPI */
+
+/* Shorthand of the C-style programs, reports the location of the macro. */
+#define EXIT_ON_MPI_FAILURE(RES) MPI::exit_on_mpi_failure(RES)
+
+#endif // MPI_SUPPORT_HPP
@@ -0,0 +1,210 @@
+#ifndef SHM_MPI_HPP
+#define SHM_MPI_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#include "mpi.h"
+
+namespace SHM
+{
+
+/*
+ * Intra-node communication through the shared memory of MPI-3: processes
+ * of the same node allocate a window with MPI_Win_allocate_shared and read
+ * the segments of each other directly instead of sending messages.
+ * Functions return MPI error code, so that the caller can handle it the same
+ * way as the rest of MPI calls.
+ */
+
+/* Communicator of the processes of 'comm' sharing memory with the calling one, ranks keep their order. */
+inline int node_comm(MPI_Comm comm, MPI_Comm* node)
+{
+  return MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, node);
+}
+
+/*
+ * Collective over 'comm'. Gives 'node' with all processes of 'comm', ranks are
+ * the same as in 'comm', if they share memory, or MPI_COMM_NULL otherwise.
+ */
+inline int single_node_comm(MPI_Comm comm, MPI_Comm* node)
+{
+  int res = node_comm(comm, node);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  int comm_size, node_size;
+
+  res = MPI_Comm_size(comm, &comm_size);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  res = MPI_Comm_size(*node, &node_size);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  /* Node sizes differ between the nodes, so the decision has to be agreed on */
+  int single = (node_size == comm_size);
+
+  res = MPI_Allreduce(MPI_IN_PLACE, &single, 1, MPI_INT, MPI_LAND, comm);
+  if (res != MPI_SUCCESS || single)
+  {
+    return res;
+  }
+
+  return MPI_Comm_free(node);
+}
+
+/*
+ * Collective over 'node'. Allocate the segment of 'bytes' of the calling process
+ * in the shared window and open the passive access epoch to all segments,
+ * so that they are accessed with plain loads and stores.
+ */
+inline int allocate(MPI_Comm node, MPI_Aint bytes, MPI_Win* win, void* base_ptr)
+{
+  int res = MPI_Win_allocate_shared(bytes, 1, MPI_INFO_NULL, node, base_ptr, win);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  return MPI_Win_lock_all(MPI_MODE_NOCHECK, *win);
+}
+
+/* Collective over the window processes. Close the access epoch and free the window. */
+inline int free_window(MPI_Win* win)
+{
+  int res = MPI_Win_unlock_all(*win);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  return MPI_Win_free(win);
+}
+
+/* Address of the segment of the process 'node_rank' in the calling process. */
+inline int segment(MPI_Win win, int node_rank, void* ptr)
+{
+  MPI_Aint bytes;
+  int disp_unit;
+
+  return MPI_Win_shared_query(win, node_rank, &bytes, &disp_unit, ptr);
+}
+
+/*
+ * Collective over 'node'. Stores of all processes to the window made before
+ * the call are visible to the loads of all processes made after it.
+ */
+inline int sync(MPI_Win win, MPI_Comm node)
+{
+  int res = MPI_Win_sync(win);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  res = MPI_Barrier(node);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  return MPI_Win_sync(win);
+}
+
+/*
+ * Point-to-point synchronization without messages: the writer stores the data
+ * into the shared memory and publishes a growing sequence number, the reader
+ * waits for the number. Counters are placed into the window with placement new.
+ */
+using counter = std::atomic<uint64_t>;
+
+static_assert(counter::is_always_lock_free, "counters in shared memory have to be lock-free");
+
+/* Waits are busy at first, then the processor is yielded for the oversubscribed nodes. */
+constexpr unsigned Spin_limit = 16;
+
+inline void publish(counter& cnt, uint64_t value)
+{
+  cnt.store(value, std::memory_order_release);
+}
+
+inline void wait_for(const counter& cnt, uint64_t value)
+{
+  for (unsigned spin = 0; cnt.load(std::memory_order_acquire) < value; ++spin)
+  {
+    if (spin >= Spin_limit)
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/*
+ * Window of the counted segments: the segment of every process is its counter
+ * followed by the payload published with it. The counter is padded to the cache
+ * line, so that the stores to the payload do not invalidate the line of the counter.
+ */
+constexpr MPI_Aint Counter_padding = 64;
+
+/* Counter and payload of a segment, 'T' is const for the segments of the other processes */
+template <typename T>
+struct counted_segment
+{
+  std::conditional_t<std::is_const_v<T>, const counter, counter>* cnt = nullptr;
+  T* data = nullptr;
+};
+
+/*
+ * Collective over 'node'. Allocate the window with the segment of 'payload' bytes
+ * after the counter of the calling process. Counters of all processes are
+ * constructed with 0 and visible to all of them on return.
+ */
+template <typename T>
+int allocate_counted(MPI_Comm node, MPI_Aint payload, MPI_Win* win, counted_segment<T>* own)
+{
+  char* base;
+
+  int res = allocate(node, Counter_padding + payload, win, &base);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  own->cnt  = new (base) counter{0};
+  own->data = reinterpret_cast<T*>(base + Counter_padding);
+
+  return sync(*win, node);
+}
+
+/* Counted segment of the process 'node_rank' in the window made by 'allocate_counted'. */
+template <typename T>
+int counted_segment_of(MPI_Win win, int node_rank, counted_segment<T>* seg)
+{
+  char* base;
+
+  int res = segment(win, node_rank, &base);
+  if (res != MPI_SUCCESS)
+  {
+    return res;
+  }
+
+  seg->cnt  = reinterpret_cast<decltype(seg->cnt)>(base);
+  seg->data = reinterpret_cast<T*>(base + Counter_padding);
+
+  return MPI_SUCCESS;
+}
+
+} /* namespace SHM */
+
+#endif /* SHM_MPI_HPP */
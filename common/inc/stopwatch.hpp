@@ -0,0 +1,38 @@
+#ifndef STOPWATCH_HPP
+#define STOPWATCH_HPP
+
+#include <chrono>
+#include <cstdint>
+
+namespace UTILS
+{
+
+class stopwatch
+{
+  using clock_t = std::chrono::steady_clock;
+  using time_point_t = clock_t::time_point;
+  time_point_t start_;
+
+public:
+  /* Starts stopwatch. */
+  void start()
+  {
+    start_ = clock_t::now();
+  }
+
+  /* Returns elapsed time in nanoseconds, stopwatch keeps running. */
+  int64_t elapsed_ns() const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start_).count();
+  }
+
+  /* Stops stopwatch and returns elapsed time in seconds with nanosecond resolution. */
+  double stop() const
+  {
+    return elapsed_ns() * 1e-9;
+  }
+};
+
+} /* namespace UTILS */
+
+#endif /* STOPWATCH_HPP */
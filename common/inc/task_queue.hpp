@@ -0,0 +1,65 @@
+#ifndef TASK_QUEUE_HPP
+#define TASK_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "mpi.h"
+
+/*
+ * Master-worker distribution of the tasks [0, tasks): process 0 keeps the queue
+ * and hands the tasks out in chunks to the processes which have returned their
+ * previous ones. Front ends are the 'dynamic' schedule of basic/work_distribution
+ * and the task farm of task_farm. Build target 'task_queue' is defined by
+ * 'common/cmake/task_queue.cmake'.
+ */
+
+namespace QUEUE
+{
+
+struct options
+{
+  /* Tasks handed out per chunk */
+  uint64_t chunk = 1;
+
+  /*
+   * The first request of a worker asks for two chunks, the results of a chunk
+   * ask for one more, so that the next chunk is at hand while the reply travels
+   */
+  bool prefetch = false;
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+};
+
+/* Work of the calling process */
+struct stats
+{
+  uint64_t tasks  = 0;
+  uint64_t chunks = 0;
+
+  /* Seconds spent in the handler and waiting for the chunks from the master */
+  double compute = 0;
+  double wait    = 0;
+};
+
+/*
+ * Computes the tasks [first, last), the result of the task 'first + idx' is written
+ * to 'out + idx * result_size'. Called on the processes the tasks are assigned to.
+ */
+using chunk_handler = std::function<void(uint64_t first, uint64_t last, std::byte* out)>;
+
+/*
+ * Collective over 'opts.comm'. Every task of [0, tasks) is computed by 'handler'
+ * on exactly one process: process 0 only serves the queue, unless it is the only one.
+ * The results of 'result_size' bytes (none if 0) travel back with the request of
+ * the next chunk and are placed to 'results' on process 0 in the order of the tasks,
+ * 'results' is not accessed on the others. Returns the work of the calling process.
+ * Throws std::invalid_argument on zero chunk.
+ */
+stats run(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+          std::byte* results, const options& opts = options{});
+
+} // namespace QUEUE
+
+#endif // TASK_QUEUE_HPP
@@ -0,0 +1,368 @@
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "stopwatch.hpp"
+
+namespace UTILS
+{
+
+/*
+ * Nearest-rank percentile of the non-empty samples sorted in ascending order:
+ * the smallest sample not exceeded by 'fraction' of them, 'fraction' is in [0; 1].
+ */
+template <typename T>
+T percentile(const std::vector<T>& sorted, double fraction)
+{
+  size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/*
+ * Run-time switch of the measurements, so that the programs are built once:
+ * - off  - nothing is measured, regions cost a single branch;
+ * - on   - time of the regions is measured and reported;
+ * - perf - hardware counters are read as well.
+ * The mode is taken from the environment variable 'PP_TIMING' ("0", "1" or "perf"),
+ * without it the default of the program is used (e.g. its build option).
+ */
+enum class timing_mode
+{
+  off,
+  on,
+  perf
+};
+
+inline timing_mode timing_mode_from_env(timing_mode default_mode = timing_mode::off)
+{
+  const char* value = std::getenv("PP_TIMING");
+
+  if (value == nullptr || *value == '\0')
+  {
+    return default_mode;
+  }
+
+  if (std::strcmp(value, "0") == 0)
+  {
+    return timing_mode::off;
+  }
+
+  return (std::strcmp(value, "perf") == 0) ? timing_mode::perf : timing_mode::on;
+}
+
+/*
+ * Hardware counters of the process read with perf_event_open. Counters are opened
+ * for the calling thread and inherited by the threads created afterwards,
+ * so they are to be opened before the threads are started and count the whole process.
+ * If the counters are not permitted (see /proc/sys/kernel/perf_event_paranoid)
+ * or not supported, they are unavailable and read as zeros.
+ */
+class perf_counters
+{
+public:
+  enum event
+  {
+    cycles,
+    instructions,
+    llc_misses,
+    events_count
+  };
+
+  using values = std::array<uint64_t, events_count>;
+
+private:
+  std::array<int, events_count> fds_;
+
+public:
+  perf_counters()
+  {
+    static const std::array<std::pair<uint32_t, uint64_t>, events_count> configs = {{
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    }};
+
+    for (int idx = 0; idx < events_count; ++idx)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+
+      attr.size = sizeof(attr);
+      attr.type = configs[idx].first;
+      attr.config = configs[idx].second;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      fds_[idx] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+  }
+
+  perf_counters(const perf_counters&) = delete;
+  perf_counters& operator=(const perf_counters&) = delete;
+
+  ~perf_counters()
+  {
+    for (int fd : fds_)
+    {
+      if (fd >= 0)
+      {
+        ::close(fd);
+      }
+    }
+  }
+
+  bool available(event ev) const noexcept
+  {
+    return fds_[ev] >= 0;
+  }
+
+  /* Current values of the counters, unavailable ones are zeros. */
+  values read() const noexcept
+  {
+    values result{};
+
+    for (int idx = 0; idx < events_count; ++idx)
+    {
+      if (fds_[idx] < 0 || ::read(fds_[idx], &result[idx], sizeof(uint64_t)) != sizeof(uint64_t))
+      {
+        result[idx] = 0;
+      }
+    }
+
+    return result;
+  }
+};
+
+/*
+ * Named regions of the program measured across iterations. Each measurement
+ * of the region is kept, so that the report gives count, total, min, median
+ * and 99th percentile of the region time. Regions may be measured from
+ * several threads at once, hardware counters are added only for the regions
+ * measured with 'scope' and count all threads of the process.
+ */
+class timing_report
+{
+  struct region
+  {
+    std::vector<int64_t> samples_ns;
+    perf_counters::values counters{};
+  };
+
+  timing_mode mode_;
+  perf_counters* counters_ = nullptr;
+
+  std::mutex mtx_;
+  std::map<std::string, region> regions_;
+
+public:
+  explicit timing_report(timing_mode mode) : mode_(mode)
+  {
+    if (mode_ == timing_mode::perf)
+    {
+      counters_ = new perf_counters;
+    }
+  }
+
+  timing_report(const timing_report&) = delete;
+  timing_report& operator=(const timing_report&) = delete;
+
+  ~timing_report()
+  {
+    delete counters_;
+  }
+
+  bool enabled() const noexcept
+  {
+    return mode_ != timing_mode::off;
+  }
+
+  /* Add one measurement of the region. */
+  void add(const std::string& name, int64_t elapsed_ns,
+           const perf_counters::values& counters = perf_counters::values{})
+  {
+    if (!enabled())
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(mtx_);
+    region& reg = regions_[name];
+
+    reg.samples_ns.push_back(elapsed_ns);
+
+    for (int idx = 0; idx < perf_counters::events_count; ++idx)
+    {
+      reg.counters[idx] += counters[idx];
+    }
+  }
+
+  /* Measures the region from construction till destruction. */
+  class scope
+  {
+    timing_report* report_;
+    std::string name_;
+
+    stopwatch sw_;
+    perf_counters::values start_counters_{};
+
+  public:
+    scope(timing_report& report, const std::string& name)
+      : report_(report.enabled() ? &report : nullptr), name_(name)
+    {
+      if (report_ == nullptr)
+      {
+        return;
+      }
+
+      if (report_->counters_ != nullptr)
+      {
+        start_counters_ = report_->counters_->read();
+      }
+
+      sw_.start();
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+    ~scope()
+    {
+      if (report_ == nullptr)
+      {
+        return;
+      }
+
+      int64_t elapsed_ns = sw_.elapsed_ns();
+      perf_counters::values counters{};
+
+      if (report_->counters_ != nullptr)
+      {
+        counters = report_->counters_->read();
+
+        for (int idx = 0; idx < perf_counters::events_count; ++idx)
+        {
+          counters[idx] -= start_counters_[idx];
+        }
+      }
+
+      report_->add(name_, elapsed_ns, counters);
+    }
+  };
+
+  /* Total time of the region in seconds, 0 if it was not measured. */
+  double total(const std::string& name)
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+
+    auto found = regions_.find(name);
+    if (found == regions_.end())
+    {
+      return 0.;
+    }
+
+    int64_t sum = 0;
+    for (int64_t sample : found->second.samples_ns)
+    {
+      sum += sample;
+    }
+
+    return sum * 1e-9;
+  }
+
+  /* Print a line per region, times are in seconds. */
+  void print(std::ostream& out)
+  {
+    if (!enabled())
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(mtx_);
+
+    out << std::left << std::setw(20) << "region" << std::right << std::setw(8) << "count"
+        << std::setw(14) << "total" << std::setw(14) << "min" << std::setw(14) << "median"
+        << std::setw(14) << "p99";
+
+    if (counters_ != nullptr)
+    {
+      out << std::setw(16) << "cycles" << std::setw(16) << "instructions" << std::setw(8) << "IPC"
+          << std::setw(14) << "LLC misses";
+    }
+
+    out << "\n";
+
+    for (auto& [name, reg] : regions_)
+    {
+      std::vector<int64_t> sorted = reg.samples_ns;
+      std::sort(sorted.begin(), sorted.end());
+
+      int64_t sum = 0;
+      for (int64_t sample : sorted)
+      {
+        sum += sample;
+      }
+
+      out << std::left << std::setw(20) << name << std::right << std::setw(8) << sorted.size()
+          << std::scientific << std::setprecision(4) << std::setw(14) << sum * 1e-9
+          << std::setw(14) << sorted.front() * 1e-9 << std::setw(14) << percentile(sorted, 0.5) * 1e-9
+          << std::setw(14) << percentile(sorted, 0.99) * 1e-9 << std::defaultfloat;
+
+      if (counters_ != nullptr)
+      {
+        print_counter(out, 16, perf_counters::cycles, reg.counters);
+        print_counter(out, 16, perf_counters::instructions, reg.counters);
+
+        if (reg.counters[perf_counters::cycles] != 0)
+        {
+          out << std::fixed << std::setprecision(2) << std::setw(8)
+              << static_cast<double>(reg.counters[perf_counters::instructions]) /
+                 reg.counters[perf_counters::cycles]
+              << std::defaultfloat;
+        }
+        else
+        {
+          out << std::setw(8) << "n/a";
+        }
+
+        print_counter(out, 14, perf_counters::llc_misses, reg.counters);
+      }
+
+      out << "\n";
+    }
+  }
+
+private:
+  void print_counter(std::ostream& out, int width, perf_counters::event ev,
+                     const perf_counters::values& values) const
+  {
+    if (counters_->available(ev))
+    {
+      out << std::setw(width) << values[ev];
+    }
+    else
+    {
+      out << std::setw(width) << "n/a";
+    }
+  }
+};
+
+} /* namespace UTILS */
+
+#endif /* TIMING_HPP */
@@ -0,0 +1,196 @@
+#ifndef VEC_SIN_HPP
+#define VEC_SIN_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace VMATH
+{
+
+/*
+ * Accuracy of the sine kernels:
+ * - libm    - scalar std::sin, reference results;
+ * - precise - polynomial kernel, error within 2.5 ulp;
+ * - fast    - shorter reduction and polynomials, absolute error about 1e-9.
+ */
+enum class accuracy
+{
+  libm,
+  precise,
+  fast
+};
+
+/* Accuracy of the kernels in the programs, set with the 'SIN_ACCURACY' build option. */
+#ifndef SIN_ACCURACY
+#define SIN_ACCURACY precise
+#endif
+
+constexpr accuracy default_accuracy = accuracy::SIN_ACCURACY;
+
+/*
+ * Arguments are reduced to [-pi/4; pi/4] as r = x - n * pi/2 with pi/2 split
+ * into the parts with trailing zero bits (Cody-Waite), n * part is exact
+ * as long as |n| < 2^20. Larger arguments are passed on to std::sin.
+ */
+constexpr double reduction_limit = 1.6e6;
+
+namespace detail
+{
+
+constexpr double two_over_pi = 6.36619772367581382433e-01;
+
+/* Adding and subtracting 1.5 * 2^52 rounds to the nearest integer, low bits hold n. */
+constexpr double round_magic = 0x1.8p52;
+
+/* pi/2 = pio2_1 + pio2_2 + pio2_3, first two parts have 33 significant bits. */
+constexpr double pio2_1 = 1.57079632673412561417e+00;
+constexpr double pio2_1t = 6.07710050650619224932e-11;
+constexpr double pio2_2 = 6.07710050630396597660e-11;
+constexpr double pio2_3 = 2.02226624871116645580e-21;
+
+/* Minimax polynomials of sin and cos on [-pi/4; pi/4] (fdlibm). */
+constexpr double S1 = -1.66666666666666324348e-01;
+constexpr double S2 = 8.33333333332248946124e-03;
+constexpr double S3 = -1.98412698298579493134e-04;
+constexpr double S4 = 2.75573137070700676789e-06;
+constexpr double S5 = -2.50507602534068634195e-08;
+constexpr double S6 = 1.58969099521155010221e-10;
+
+constexpr double C1 = 4.16666666666666019037e-02;
+constexpr double C2 = -1.38888888888741095749e-03;
+constexpr double C3 = 2.48015872894767294178e-05;
+constexpr double C4 = -2.75573143513906633035e-07;
+constexpr double C5 = 2.08757232129817482790e-09;
+constexpr double C6 = -1.13596475577881948265e-11;
+
+/* Taylor polynomials of the fast kernel, truncated after x^9 and x^10. */
+constexpr double F_S1 = -1. / 6;
+constexpr double F_S2 = 1. / 120;
+constexpr double F_S3 = -1. / 5040;
+constexpr double F_S4 = 1. / 362880;
+
+constexpr double F_C1 = 1. / 24;
+constexpr double F_C2 = -1. / 720;
+constexpr double F_C3 = 1. / 40320;
+constexpr double F_C4 = -1. / 3628800;
+
+/*
+ * Sine of |x| < reduction_limit without branches, so that the loops
+ * calling it are vectorized. The quadrant n mod 4 selects the polynomial
+ * (sin for even n, cos for odd n) and the sign of the result.
+ */
+template <accuracy A>
+inline double sin_reduced(double x)
+{
+  double shifted = x * two_over_pi + round_magic;
+  uint64_t quadrant = std::bit_cast<uint64_t>(shifted);
+  double n = shifted - round_magic;
+
+  double r;
+  if constexpr (A == accuracy::fast)
+  {
+    r = (x - n * pio2_1) - n * pio2_1t;
+  }
+  else
+  {
+    r = ((x - n * pio2_1) - n * pio2_2) - n * pio2_3;
+  }
+
+  double z = r * r;
+  double s, c;
+
+  if constexpr (A == accuracy::fast)
+  {
+    s = r + r * z * (F_S1 + z * (F_S2 + z * (F_S3 + z * F_S4)));
+    c = 1. - 0.5 * z + z * z * (F_C1 + z * (F_C2 + z * (F_C3 + z * F_C4)));
+  }
+  else
+  {
+    s = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+
+    double hz = 0.5 * z;
+    double w = 1. - hz;
+    c = w + (((1. - w) - hz) + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6))))));
+  }
+
+  uint64_t cos_mask = 0 - (quadrant & 1);
+  uint64_t sign = (quadrant & 2) << 62;
+
+  uint64_t bits = (std::bit_cast<uint64_t>(s) & ~cos_mask) | (std::bit_cast<uint64_t>(c) & cos_mask);
+  return std::bit_cast<double>(bits ^ sign);
+}
+
+} /* namespace detail */
+
+/* Sine of a single argument with the given accuracy. */
+template <accuracy A = default_accuracy>
+inline double sin(double x)
+{
+  if constexpr (A == accuracy::libm)
+  {
+    return std::sin(x);
+  }
+  else
+  {
+    return (std::abs(x) < reduction_limit) ? detail::sin_reduced<A>(x) : std::sin(x);
+  }
+}
+
+/* Values processed at once by 'sin_scaled', the block stays in L1 cache. */
+constexpr size_t block_size = 512;
+
+/*
+ * values[idx] = sin(scale * values[idx]) for 'count' consecutive values.
+ * The polynomial kernel is computed for a block of values without branches,
+ * if any argument of the block is out of the reduction range,
+ * the block is recomputed value by value.
+ */
+template <accuracy A = default_accuracy>
+inline void sin_scaled(double* values, size_t count, double scale)
+{
+  if constexpr (A == accuracy::libm)
+  {
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+      values[idx] = std::sin(scale * values[idx]);
+    }
+  }
+  else
+  {
+    double result[block_size];
+
+    for (size_t begin = 0; begin < count; begin += block_size)
+    {
+      size_t size = std::min(block_size, count - begin);
+      double* block = values + begin;
+
+      double max_arg = 0.;
+
+#pragma omp simd reduction(max : max_arg)
+      for (size_t idx = 0; idx < size; ++idx)
+      {
+        double x = scale * block[idx];
+        max_arg = std::max(max_arg, std::abs(x));
+        result[idx] = detail::sin_reduced<A>(x);
+      }
+
+      if (max_arg < reduction_limit)
+      {
+        std::copy(result, result + size, block);
+        continue;
+      }
+
+      for (size_t idx = 0; idx < size; ++idx)
+      {
+        block[idx] = sin<A>(scale * block[idx]);
+      }
+    }
+  }
+}
+
+} /* namespace VMATH */
+
+#endif /* VEC_SIN_HPP */
@@ -0,0 +1,82 @@
+#!/usr/bin/python3
+
+import os
+import sys
+import csv
+import argparse
+from collections import defaultdict
+
+# ==================
+
+# Graphs drawn for each target: CSV column, axis label, file suffix
+GRAPHS = [
+    ("time_min", "time, sec", "T"),
+    ("speedup", "S(p)", "S"),
+    ("efficiency", "E(p)", "E"),
+]
+
+# ==================
+
+
+def parse_args(argv):
+    """
+    Parse sys.argv for arguments of prog.
+    """
+    parser = argparse.ArgumentParser(
+        description="Draw time, speedup and efficiency graphs from the CSV of scaling_bench.py")
+
+    parser.add_argument("input", help="CSV written by scaling_bench.py")
+    parser.add_argument("--output-dir", default=".", help="directory for the images")
+
+    return parser.parse_args(argv[1:])
+
+
+def load(path):
+    """
+    Read the results grouped by target and problem size.
+    """
+    results = defaultdict(lambda: defaultdict(list))
+
+    with open(path, newline="") as input_file:
+        for row in csv.DictReader(input_file):
+            results[row["target"]][row["size"]].append(row)
+
+    return results
+
+
+# ==================
+
+args = parse_args(sys.argv)
+
+try:
+    import matplotlib
+    matplotlib.use("Agg")
+    import matplotlib.pyplot as plt
+except ImportError:
+    print("matplotlib is required to draw the graphs")
+    sys.exit(1)
+
+os.makedirs(args.output_dir, exist_ok=True)
+
+for target, sizes in load(args.input).items():
+    for column, label, suffix in GRAPHS:
+
+        fig, ax = plt.subplots(figsize=(8, 5))
+
+        for size, rows in sizes.items():
+            workers = [int(row["workers"]) for row in rows]
+            values = [float(row[column]) for row in rows]
+            ax.plot(workers, values, marker="o", label=f"size {size}")
+
+        ax.set_xscale("log", base=2)
+        ax.set_xlabel("p")
+        ax.set_ylabel(label)
+        ax.set_title(f"{target} {label}")
+        ax.grid(True)
+        ax.legend()
+
+        path = os.path.join(args.output_dir, f"graph_{target}_{suffix}.png")
+        fig.savefig(path, dpi=100, bbox_inches="tight")
+        plt.close(fig)
+
+        print(path)
@@ -0,0 +1,208 @@
+#!/usr/bin/python3
+
+import sys
+import os
+import re
+import csv
+import shlex
+import argparse
+import statistics
+import subprocess
+
+# ==================
+
+# Root of the repository, projects are built from their directories
+REPO = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+ELAPSED = r"Total elapsed: (\S+) sec"
+
+#
+# Benchmarked targets:
+#   project - directory of the CMake project
+#   binary  - path of the executable in the build directory
+#   launch  - 'omp' (OMP_NUM_THREADS), 'mpi' (launcher -n) or 'threads' (first argument)
+#   sizes   - default problem sizes
+#   build   - CMake options, '{size}' is replaced with the problem size
+#   args    - program arguments, '{size}' and '{workers}' are replaced
+#   pattern - regular expression of the elapsed time in seconds in the output
+#
+TARGETS = {
+    "task01_OMP": dict(
+        project="cycle_parallelization", binary="omp/task01_OMP", launch="omp",
+        sizes=["4000", "8000"],
+        build=["-DPARALLEL=ON", "-DTIMING=ON", "-DQUIET=ON", "-DISIZE={size}", "-DJSIZE={size}"],
+        args=[], pattern=ELAPSED),
+    "task02_OMP": dict(
+        project="cycle_parallelization", binary="omp/task02_OMP", launch="omp",
+        sizes=["4000", "8000"],
+        build=["-DPARALLEL=ON", "-DTIMING=ON", "-DQUIET=ON", "-DISIZE={size}", "-DJSIZE={size}"],
+        args=[], pattern=ELAPSED),
+    "task01_MPI": dict(
+        project="cycle_parallelization", binary="mpi/task01_MPI", launch="mpi",
+        sizes=["4000", "8000"],
+        build=["-DPARALLEL=ON", "-DTIMING=ON", "-DQUIET=ON", "-DISIZE={size}", "-DJSIZE={size}"],
+        args=[], pattern=ELAPSED),
+    "parallel": dict(
+        project="transfer_equation", binary="parallel", launch="mpi",
+        sizes=["100000", "1000000"],
+        build=[],
+        args=["--x-points", "{size}"], pattern=r"Elapsed: (\S+) sec"),
+    "global_stack": dict(
+        project="global_stack", binary="integrate", launch="threads",
+        sizes=["1e-4", "1e-5"],
+        build=["-DTIME=ON"],
+        args=["{workers}", "{size}"], pattern=ELAPSED),
+}
+
+FIELDS = ["target", "size", "workers", "reps", "time_min", "time_median",
+          "speedup", "efficiency", "karp_flatt"]
+
+# ==================
+
+
+def parse_args(argv):
+    """
+    Parse sys.argv for arguments of prog.
+    """
+    parser = argparse.ArgumentParser(
+        description="Measure scaling of the parallel programs over the numbers of workers "
+                    "(threads or ranks) and problem sizes, write the results as CSV")
+
+    parser.add_argument("--targets", default=",".join(TARGETS),
+                        help="comma separated targets: " + ", ".join(TARGETS))
+    parser.add_argument("--workers", default="1,2,4,8",
+                        help="comma separated numbers of threads or ranks")
+    parser.add_argument("--sizes", action="append", default=[], metavar="TARGET=SIZES",
+                        help="comma separated problem sizes of the target: array side for the "
+                             "cycle tasks, x points for 'parallel', left bound for 'global_stack'")
+    parser.add_argument("--reps", type=int, default=3, help="repetitions of each run")
+    parser.add_argument("--build-root", default="bench_build", help="directory for the builds")
+    parser.add_argument("--mpirun", default="mpirun", help="MPI launcher with its options")
+    parser.add_argument("--output", help="CSV file, standard output if not given")
+
+    args = parser.parse_args(argv[1:])
+
+    args.targets = args.targets.split(",")
+    args.workers = sorted({int(workers) for workers in args.workers.split(",")} | {1})
+    args.mpirun = shlex.split(args.mpirun)
+
+    unknown = [target for target in args.targets if target not in TARGETS]
+    if unknown:
+        print("Domain error: unknown targets " + ", ".join(unknown))
+        sys.exit(1)
+
+    sizes = {target: TARGETS[target]["sizes"] for target in args.targets}
+    for spec in args.sizes:
+        target, _, values = spec.partition("=")
+        if target not in sizes or not values:
+            print("Domain error: invalid sizes " + spec)
+            sys.exit(1)
+        sizes[target] = values.split(",")
+    args.sizes = sizes
+
+    if args.workers[0] < 1 or args.reps < 1:
+        print("Domain error: workers and reps must be positive")
+        sys.exit(1)
+
+    return args
+
+
+# ------------------
+
+
+def build(args, target, size):
+    """
+    Configure and build the project of the target for the problem size,
+    return path of the executable. Builds are reused between runs.
+    """
+    desc = TARGETS[target]
+    options = [option.format(size=size) for option in desc["build"]]
+
+    # Projects with the size fixed at compile time are built for each size
+    suffix = "_" + size if any("{size}" in option for option in desc["build"]) else ""
+    build_dir = os.path.join(args.build_root, desc["project"] + suffix)
+
+    subprocess.run(["cmake", "-S", os.path.join(REPO, desc["project"]), "-B", build_dir]
+                   + options, check=True, capture_output=True)
+    subprocess.run(["cmake", "--build", build_dir, "-j", "--target",
+                    os.path.basename(desc["binary"])], check=True, capture_output=True)
+
+    return os.path.join(build_dir, desc["binary"])
+
+
+def run(args, target, binary, size, workers):
+    """
+    Run the target and return elapsed times of all repetitions.
+    """
+    desc = TARGETS[target]
+    env = dict(os.environ)
+
+    cmd = [os.path.abspath(binary)] + [arg.format(size=size, workers=workers)
+                                       for arg in desc["args"]]
+
+    if desc["launch"] == "omp":
+        env["OMP_NUM_THREADS"] = str(workers)
+    elif desc["launch"] == "mpi":
+        cmd = args.mpirun + ["-n", str(workers)] + cmd
+
+    times = []
+
+    for _ in range(args.reps):
+        # Programs are run in the build directory, output files stay there
+        proc = subprocess.run(cmd, env=env, cwd=os.path.dirname(binary),
+                              capture_output=True, text=True, check=True)
+        match = re.search(desc["pattern"], proc.stdout + proc.stderr)
+
+        if match is None:
+            print(f"Domain error: no elapsed time in the output of {target}", file=sys.stderr)
+            sys.exit(1)
+
+        times.append(float(match.group(1)))
+
+    return times
+
+
+def scaling(time, base, workers):
+    """
+    Speedup, efficiency and Karp-Flatt experimentally determined serial fraction
+    e = (1/S - 1/p) / (1 - 1/p), the latter is not defined for a single worker.
+    """
+    speedup = base / time
+    efficiency = speedup / workers
+
+    if workers == 1:
+        return speedup, efficiency, ""
+
+    return speedup, efficiency, f"{(1 / speedup - 1 / workers) / (1 - 1 / workers):.4f}"
+
+
+# ==================
+
+args = parse_args(sys.argv)
+
+output = open(args.output, "w", newline="") if args.output else sys.stdout
+writer = csv.DictWriter(output, fieldnames=FIELDS)
+writer.writeheader()
+
+for target in args.targets:
+    for size in args.sizes[target]:
+
+        binary = build(args, target, size)
+        base = None
+
+        for workers in args.workers:
+
+            times = run(args, target, binary, size, workers)
+            time = min(times)
+
+            # Workers are sorted, single worker run goes first
+            base = time if base is None else base
+            speedup, efficiency, karp_flatt = scaling(time, base, workers)
+
+            writer.writerow({
+                "target": target, "size": size, "workers": workers, "reps": args.reps,
+                "time_min": f"{time:.6f}", "time_median": f"{statistics.median(times):.6f}",
+                "speedup": f"{speedup:.4f}", "efficiency": f"{efficiency:.4f}",
+                "karp_flatt": karp_flatt,
+            })
+            output.flush()
@@ -0,0 +1,98 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "field_format.hpp"
+
+namespace
+{
+
+void print_usage(const char* prog)
+{
+  std::cerr << "Usage: " << prog << " [--info] <input.bin> [output.txt]\n"
+            << "  --info  print header only\n";
+}
+
+void print_header(const FIELD::header& hdr)
+{
+  std::cout << "ndims: " << hdr.ndims << "\n"
+            << "dims: " << hdr.dims[0] << " x " << hdr.dims[1] << "\n"
+            << "dtype: float64\n"
+            << "spacing: " << hdr.spacing[0] << " " << hdr.spacing[1] << "\n";
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char** argv)
+{
+  bool info_only = false;
+
+  int arg_idx = 1;
+  if (arg_idx < argc && std::strcmp(argv[arg_idx], "--info") == 0)
+  {
+    info_only = true;
+    ++arg_idx;
+  }
+
+  if (arg_idx >= argc || argc - arg_idx > 2)
+  {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream input(argv[arg_idx], std::ios::binary);
+  if (!input.is_open())
+  {
+    std::cerr << "Cannot open " << argv[arg_idx] << "\n";
+    return EXIT_FAILURE;
+  }
+
+  FIELD::header hdr;
+  if (!input.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)) || !FIELD::is_valid(hdr))
+  {
+    std::cerr << argv[arg_idx] << " is not a field file\n";
+    return EXIT_FAILURE;
+  }
+
+  if (info_only)
+  {
+    print_header(hdr);
+    return 0;
+  }
+
+  std::ofstream output_file;
+  if (arg_idx + 1 < argc)
+  {
+    output_file.open(argv[arg_idx + 1]);
+    if (!output_file.is_open())
+    {
+      std::cerr << "Cannot open " << argv[arg_idx + 1] << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ostream& output = output_file.is_open() ? output_file : std::cout;
+
+  /* Text layout matches the one previously produced by the programs: one row per line. */
+  std::vector<double> row(hdr.dims[1]);
+
+  for (uint64_t i = 0; i < hdr.dims[0]; ++i)
+  {
+    if (!input.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(double)))
+    {
+      std::cerr << "Unexpected end of file at row " << i << "\n";
+      return EXIT_FAILURE;
+    }
+
+    for (double value : row)
+    {
+      output << value << ' ';
+    }
+
+    output << '\n';
+  }
+
+  return 0;
+}
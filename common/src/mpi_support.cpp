@@ -0,0 +1,134 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+
+namespace MPI
+{
+
+void exit_on_mpi_failure(const int res, const std::source_location& sloc)
+{
+  if (res != MPI_SUCCESS)
+  {
+    std::cerr << "MPI failed at: " << sloc.file_name() << " " << sloc.function_name() << ":"
+              << sloc.line() << std::endl;
+
+    int eclass, elength;
+    char estring[MPI_MAX_ERROR_STRING + 1];
+
+    MPI_Error_class(res, &eclass);
+    MPI_Error_string(res, estring, &elength);
+
+    std::cerr << "Error " << eclass << " : " << estring << std::endl;
+
+    int initialized, finalized;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+
+    if (initialized && !finalized)
+    {
+      MPI_Finalize();
+    }
+
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+MPI_env::MPI_env(int& argc, char**& argv)
+{
+  /* MPI env initialization. */
+  int res = MPI_Init(&argc, &argv);
+  exit_on_mpi_failure(res);
+}
+
+MPI_env::MPI_env(int& argc, char**& argv, int required)
+{
+  int res = MPI_Init_thread(&argc, &argv, required, &provided_);
+  exit_on_mpi_failure(res);
+}
+
+MPI_env::~MPI_env()
+{
+  /* MPI env finalization. */
+  int res = MPI_Finalize();
+  exit_on_mpi_failure(res);
+}
+
+void request::release()
+{
+  int finalized;
+  MPI_Finalized(&finalized);
+
+  if (finalized)
+  {
+    return;
+  }
+
+  /* Waiting for the inactive persistent request or for the null one returns at once. */
+  if (req_ != MPI_REQUEST_NULL)
+  {
+    exit_on_mpi_failure(MPI_Wait(&req_, MPI_STATUS_IGNORE));
+  }
+
+  if (persistent_ && req_ != MPI_REQUEST_NULL)
+  {
+    exit_on_mpi_failure(MPI_Request_free(&req_));
+  }
+
+  req_ = MPI_REQUEST_NULL;
+  persistent_ = false;
+}
+
+namespace
+{
+
+/* Handles of the requests are copied into a contiguous array, small groups stay on the stack. */
+constexpr std::size_t Small_group = 16;
+
+template <typename Call>
+void with_handles(std::span<request> requests, Call call)
+{
+  std::array<MPI_Request, Small_group> small;
+  std::vector<MPI_Request> large;
+
+  MPI_Request* handles = small.data();
+
+  if (requests.size() > Small_group)
+  {
+    large.resize(requests.size());
+    handles = large.data();
+  }
+
+  for (std::size_t idx = 0; idx < requests.size(); ++idx)
+  {
+    handles[idx] = requests[idx].native();
+  }
+
+  call(static_cast<int>(requests.size()), handles);
+
+  for (std::size_t idx = 0; idx < requests.size(); ++idx)
+  {
+    requests[idx].native() = handles[idx];
+  }
+}
+
+} /* anonymous namespace */
+
+void wait_all(std::span<request> requests, const std::source_location& sloc)
+{
+  with_handles(requests, [&sloc](int count, MPI_Request* handles) {
+    exit_on_mpi_failure(MPI_Waitall(count, handles, MPI_STATUSES_IGNORE), sloc);
+  });
+}
+
+void start_all(std::span<request> requests, const std::source_location& sloc)
+{
+  with_handles(requests, [&sloc](int count, MPI_Request* handles) {
+    exit_on_mpi_failure(MPI_Startall(count, handles), sloc);
+  });
+}
+
+} /* namespace MPI */
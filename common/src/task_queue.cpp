@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "task_queue.hpp"
+
+namespace QUEUE
+{
+
+namespace
+{
+
+/* Results of a chunk with the request of the next ones, and the reply of the master */
+const int Result_tag = 1;
+const int Assign_tag = 2;
+
+/*
+ * Header of the results message. The first message of a worker carries no results,
+ * only the request. Size of the header keeps the results after it aligned for any type.
+ */
+struct header
+{
+  uint64_t first;
+  uint64_t count;
+
+  /* Chunks requested, 0 - the master has run out of the tasks */
+  uint64_t want;
+
+  uint64_t reserved;
+};
+
+static_assert(sizeof(header) % alignof(std::max_align_t) == 0);
+
+/* Tasks handed out by the master { first task, number of tasks }, no tasks - no more */
+using assignment = std::array<uint64_t, 2>;
+
+void compute(uint64_t first, uint64_t last, std::byte* out, const chunk_handler& handler,
+             stats& work)
+{
+  MPI::stopwatch sw;
+  sw.start();
+
+  handler(first, last, out);
+
+  work.compute += sw.stop();
+  work.tasks   += last - first;
+  work.chunks  += 1;
+}
+
+stats run_single(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+                 std::byte* results, uint64_t chunk)
+{
+  stats work;
+
+  for (uint64_t first = 0; first < tasks; first += std::min(chunk, tasks - first))
+  {
+    compute(first, first + std::min(chunk, tasks - first),
+            (result_size > 0) ? results + first * result_size : nullptr, handler, work);
+  }
+
+  return work;
+}
+
+/*
+ * Master: place the results and answer the requests, until all of the results
+ * have been returned and every worker has been answered at least once
+ */
+void serve_queue(uint64_t tasks, std::size_t result_size, std::byte* results, uint64_t chunk,
+                 MPI_Comm comm, int size)
+{
+  uint64_t next     = 0;
+  uint64_t returned = 0;
+  int greeted = 0;
+
+  std::vector<std::byte> message;
+
+  while (returned < tasks || greeted < size - 1)
+  {
+    MPI_Status status;
+
+    int res = MPI_Probe(MPI_ANY_SOURCE, Result_tag, comm, &status);
+    MPI::exit_on_mpi_failure(res);
+
+    int bytes;
+
+    res = MPI_Get_count(&status, MPI_BYTE, &bytes);
+    MPI::exit_on_mpi_failure(res);
+
+    message.resize(bytes);
+    MPI::recv(message, status.MPI_SOURCE, Result_tag, comm);
+
+    header head;
+    std::memcpy(&head, message.data(), sizeof(header));
+
+    if (head.count == 0)
+    {
+      ++greeted;
+    }
+    else
+    {
+      if (result_size > 0)
+      {
+        std::memcpy(results + head.first * result_size, message.data() + sizeof(header),
+                    head.count * result_size);
+      }
+
+      returned += head.count;
+    }
+
+    if (head.want == 0)
+    {
+      continue;
+    }
+
+    /* Chunks requested at once are consecutive, they are sent as one range */
+    uint64_t left  = tasks - next;
+    uint64_t count = (left / head.want < chunk) ? left : head.want * chunk;
+
+    MPI::send(assignment{next, count}, status.MPI_SOURCE, Assign_tag, comm);
+    next += count;
+  }
+}
+
+/*
+ * Worker: compute the chunks at hand, the results of each one request the next chunk.
+ * With the prefetch one chunk more is at hand, it is computed while the request travels.
+ */
+stats request_chunks(std::size_t result_size, const chunk_handler& handler, uint64_t chunk,
+                     bool prefetch, MPI_Comm comm)
+{
+  stats work;
+
+  std::deque<assignment> at_hand;
+  std::vector<std::byte> message(sizeof(header));
+
+  assignment reply;
+  MPI::request pending;
+
+  bool waiting = false;
+  bool more    = true;
+
+  /* Chunks requested by the last message */
+  uint64_t want = 0;
+
+  /* Split the reply into the chunks, fewer tasks than requested mean the queue is empty */
+  auto accept = [&]()
+  {
+    MPI::stopwatch sw;
+    sw.start();
+
+    pending.wait();
+
+    work.wait += sw.stop();
+    waiting = false;
+
+    uint64_t last = reply[0] + reply[1];
+
+    for (uint64_t first = reply[0]; first < last; first += chunk)
+    {
+      at_hand.push_back(assignment{first, std::min(chunk, last - first)});
+    }
+
+    if (reply[1] / want < chunk)
+    {
+      more = false;
+    }
+  };
+
+  auto request = [&](uint64_t first, uint64_t count, uint64_t chunks)
+  {
+    want = chunks;
+
+    header head{first, count, want, 0};
+    std::memcpy(message.data(), &head, sizeof(header));
+
+    MPI::send(message, 0, Result_tag, comm);
+
+    if (want > 0)
+    {
+      pending = MPI::irecv(reply, 0, Assign_tag, comm);
+      waiting = true;
+    }
+  };
+
+  request(0, 0, prefetch ? 2 : 1);
+
+  while (!at_hand.empty() || waiting)
+  {
+    if (at_hand.empty())
+    {
+      accept();
+      continue;
+    }
+
+    auto [first, count] = at_hand.front();
+    at_hand.pop_front();
+
+    message.resize(sizeof(header) + count * result_size);
+    compute(first, first + count, message.data() + sizeof(header), handler, work);
+
+    /* Reply to the previous results has arrived during the computation */
+    if (waiting)
+    {
+      accept();
+    }
+
+    request(first, count, more ? 1 : 0);
+  }
+
+  return work;
+}
+
+} // namespace
+
+stats run(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+          std::byte* results, const options& opts)
+{
+  if (opts.chunk == 0)
+  {
+    throw std::invalid_argument("chunk must be positive");
+  }
+
+  int size, rank;
+
+  int res = MPI_Comm_size(opts.comm, &size);
+  MPI::exit_on_mpi_failure(res);
+
+  res = MPI_Comm_rank(opts.comm, &rank);
+  MPI::exit_on_mpi_failure(res);
+
+  if (size == 1)
+  {
+    return run_single(tasks, result_size, handler, results, opts.chunk);
+  }
+
+  if (rank == 0)
+  {
+    serve_queue(tasks, result_size, results, opts.chunk, opts.comm, size);
+    return stats{};
+  }
+
+  return request_chunks(result_size, handler, opts.chunk, opts.prefetch, opts.comm);
+}
+
+} // namespace QUEUE
@@ -1,167 +1,550 @@
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include <cstdlib>
 #include <new>
 #include <iostream>
-
-#ifndef QUIET
-#include <fstream>
-#endif
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "mpi.h"
 #include "mpi_support.hpp"
+#include "decomposition_mpi.hpp"
+#include "shm_mpi.hpp"
+#include "vec_sin.hpp"
+
+#ifndef QUIET
+#include "field_mpi_io.hpp"
+#endif
 
 namespace
 {
-/* Array dimensions. */
-const int Isize = 24000;
-const int Jsize = 24000;
+/* Array dimensions, may be changed with the 'ISIZE' and 'JSIZE' build options. */
+#ifndef ISIZE
+#define ISIZE 24000
+#endif
+
+#ifndef JSIZE
+#define JSIZE 24000
+#endif
+
+const int Isize = ISIZE;
+const int Jsize = JSIZE;
 
 using row = double[Jsize];
 
-void main_process_prepare(row* array)
+/*
+ * How the rows get to the processes:
+ * - scatter  - rank 0 fills the whole array, rows are sent with MPI_Scatterv
+ *              and results are collected with MPI_Gatherv;
+ * - pipeline - rank 0 fills the whole array and streams the rows by chunks
+ *              with non-blocking sends, processes start computing on the first chunk
+ *              and send every chunk back as soon as it is computed;
+ * - local    - every process fills its own rows, nothing is sent;
+ * - shared   - rank 0 fills the whole array in the shared memory window,
+ *              processes of one node compute their rows in place there,
+ *              nothing is copied. Falls back to 'scatter' on several nodes.
+ */
+enum class transfer_mode
+{
+  scatter,
+  pipeline,
+  local,
+  shared
+};
+
+struct run_options
 {
-  for (int i = 0; i < Isize; i++)
+  transfer_mode transfer = transfer_mode::scatter;
+
+  /* Rows per message in the 'pipeline' mode. */
+  int chunk = 64;
+
+  /* File with the weights of the processes, empty for the even decomposition. */
+  std::string balance;
+};
+
+const char* options_usage()
+{
+  return "[--transfer scatter|pipeline|local|shared] [--chunk <rows>] [<weights file>]";
+}
+
+/* Throws std::invalid_argument on unknown or malformed option. */
+run_options parse_options(int argc, char** argv)
+{
+  run_options options;
+
+  for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
   {
-    for (int j = 0; j < Jsize; j++)
+    std::string name = argv[arg_idx];
+
+    if (name.rfind("--", 0) != 0)
+    {
+      options.balance = name;
+      continue;
+    }
+
+    if (arg_idx + 1 >= argc)
+    {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[++arg_idx];
+
+    if (name == "--transfer")
     {
-      array[i][j] = 10 * i + j;
+      if (value == "scatter")
+        options.transfer = transfer_mode::scatter;
+      else if (value == "pipeline")
+        options.transfer = transfer_mode::pipeline;
+      else if (value == "local")
+        options.transfer = transfer_mode::local;
+      else if (value == "shared")
+        options.transfer = transfer_mode::shared;
+      else
+        throw std::invalid_argument("unknown transfer mode " + value);
+    }
+    else if (name == "--chunk")
+    {
+      options.chunk = std::stoi(value);
+
+      if (options.chunk <= 0)
+      {
+        throw std::invalid_argument("chunk must be positive");
+      }
+    }
+    else
+    {
+      throw std::invalid_argument("unknown option " + name);
     }
   }
+
+  return options;
 }
 
-void process_compute(int cluster_size, row* cluster)
+/* Fill 'count' rows starting from the row 'first' with some data. */
+void process_prepare(int first, int count, row* rows)
 {
-  for (int i = 0; i < cluster_size; i++)
+  for (int i = 0; i < count; i++)
   {
     for (int j = 0; j < Jsize; j++)
     {
-      cluster[i][j] = sin(2 * cluster[i][j]);
+      rows[i][j] = 10 * (first + i) + j;
     }
   }
 }
 
-void main_process_send(int cluster_size, int rank, const row* cluster)
+void process_compute(int cluster_size, row* cluster)
+{
+  for (int i = 0; i < cluster_size; i++)
+  {
+    /* cluster[i][j] = sin(2 * cluster[i][j]), vectorized kernel of the accuracy chosen by 'SIN_ACCURACY'. */
+    VMATH::sin_scaled(cluster[i], Jsize, 2.);
+  }
+}
+
+/* Counts and displacements of the blocks of the processes in rows. */
+void block_layout(const DECOMP::offsets& offsets, std::vector<int>& counts, std::vector<int>& displs)
+{
+  int comm_size = offsets.size() - 1;
+
+  counts.resize(comm_size);
+  displs.resize(comm_size);
+
+  for (int rank = 0; rank < comm_size; ++rank)
+  {
+    counts[rank] = offsets[rank + 1] - offsets[rank];
+    displs[rank] = offsets[rank];
+  }
+}
+
+/*
+ * Distribute the rows of 'array' on rank 0 between the processes,
+ * rank 0 keeps its block in place. 'array' is used on rank 0 only.
+ */
+void process_scatter(const DECOMP::offsets& offsets, int rank, MPI_Datatype row_type,
+                     const row* array, row* cluster)
 {
-  int res = MPI_Send(
-    &cluster[cluster_size * rank],
-    Jsize * cluster_size,
-    MPI_DOUBLE,
-    rank,
-    MPI::Msg_tag,
-    MPI_COMM_WORLD);
+  std::vector<int> counts, displs;
+  block_layout(offsets, counts, displs);
+
+  int res = (rank == 0)
+    ? MPI_Scatterv(array, counts.data(), displs.data(), row_type,
+                   MPI_IN_PLACE, counts[0], row_type, 0, MPI_COMM_WORLD)
+    : MPI_Scatterv(nullptr, nullptr, nullptr, row_type,
+                   cluster, counts[rank], row_type, 0, MPI_COMM_WORLD);
   MPI::exit_on_mpi_failure(res);
 }
 
-void main_process_recv(int cluster_size, int rank, row* cluster)
+/* Collect the computed rows of the processes into 'array' on rank 0. */
+void process_gather(const DECOMP::offsets& offsets, int rank, MPI_Datatype row_type,
+                    const row* cluster, row* array)
 {
-  int res = MPI_Recv(
-    &cluster[cluster_size * rank],
-    Jsize * cluster_size,
-    MPI_DOUBLE,
-    rank,
-    MPI::Msg_tag,
-    MPI_COMM_WORLD,
-    MPI_STATUS_IGNORE);
+  std::vector<int> counts, displs;
+  block_layout(offsets, counts, displs);
+
+  int res = (rank == 0)
+    ? MPI_Gatherv(MPI_IN_PLACE, counts[0], row_type,
+                  array, counts.data(), displs.data(), row_type, 0, MPI_COMM_WORLD)
+    : MPI_Gatherv(cluster, counts[rank], row_type,
+                  nullptr, nullptr, nullptr, row_type, 0, MPI_COMM_WORLD);
   MPI::exit_on_mpi_failure(res);
 }
 
-#ifndef QUIET
-void main_process_print(row* array)
+/* Number of rows in the chunk 'idx' of the block of 'rows' rows. */
+int chunk_rows(int rows, int chunk, int idx)
+{
+  return std::min(chunk, rows - idx * chunk);
+}
+
+int chunk_count(int rows, int chunk)
+{
+  return (rows + chunk - 1) / chunk;
+}
+
+/*
+ * Stream the blocks of the secondary processes from rank 0 by chunks and
+ * compute the own block meanwhile. Chunks are sent round-robin, so that every
+ * process gets its first chunk early. Returns time of the own computations.
+ */
+double main_process_stream(const DECOMP::offsets& offsets, int chunk, MPI_Datatype row_type,
+                           row* array)
 {
-  auto result_file = std::ofstream("result.txt");
-  if (!result_file.is_open())
+  int comm_size = offsets.size() - 1;
+
+  int max_chunks = 0;
+  for (int rank = 1; rank < comm_size; ++rank)
+  {
+    max_chunks = std::max(max_chunks, chunk_count(offsets[rank + 1] - offsets[rank], chunk));
+  }
+
+  std::vector<MPI_Request> requests;
+
+  for (int idx = 0; idx < max_chunks; ++idx)
   {
-    int res = MPI_Finalize();
+    for (int rank = 1; rank < comm_size; ++rank)
+    {
+      int rows = offsets[rank + 1] - offsets[rank];
+
+      if (idx < chunk_count(rows, chunk))
+      {
+        requests.emplace_back();
+        int res = MPI_Isend(&array[offsets[rank] + idx * chunk], chunk_rows(rows, chunk, idx),
+                            row_type, rank, MPI::Msg_tag, MPI_COMM_WORLD, &requests.back());
+        MPI::exit_on_mpi_failure(res);
+      }
+    }
+  }
+
+  /* Own block is computed by chunks too, testing the sends lets MPI progress them. */
+  double compute_time = 0.;
+
+  for (int idx = 0; idx < chunk_count(offsets[1], chunk); ++idx)
+  {
+    double compute_start = MPI_Wtime();
+    process_compute(chunk_rows(offsets[1], chunk, idx), &array[idx * chunk]);
+    compute_time += MPI_Wtime() - compute_start;
+
+    int done;
+    int res = MPI_Testall(requests.size(), requests.data(), &done, MPI_STATUSES_IGNORE);
     MPI::exit_on_mpi_failure(res);
   }
 
-  for (int i = 0; i < Isize; i++)
+  int res = MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+  MPI::exit_on_mpi_failure(res);
+
+  /* Rows are sent, results are received into the same place. */
+  requests.clear();
+
+  for (int rank = 1; rank < comm_size; ++rank)
   {
-    for (int j = 0; j < Jsize; j++)
+    int rows = offsets[rank + 1] - offsets[rank];
+
+    for (int idx = 0; idx < chunk_count(rows, chunk); ++idx)
     {
-      result_file << a[i][j] << ' ';
+      requests.emplace_back();
+      res = MPI_Irecv(&array[offsets[rank] + idx * chunk], chunk_rows(rows, chunk, idx),
+                      row_type, rank, MPI::Msg_tag, MPI_COMM_WORLD, &requests.back());
+      MPI::exit_on_mpi_failure(res);
     }
+  }
+
+  res = MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+  MPI::exit_on_mpi_failure(res);
+
+  return compute_time;
+}
 
-    result_file << std::endl;
+/*
+ * Receive the block from rank 0 by chunks, compute every chunk as soon as
+ * it arrives and send it back. Returns time of the computations.
+ */
+double secondary_process_stream(int cluster_size, int chunk, MPI_Datatype row_type, row* cluster)
+{
+  int chunks = chunk_count(cluster_size, chunk);
+
+  std::vector<MPI_Request> recv_requests(chunks);
+  std::vector<MPI_Request> send_requests(chunks);
+
+  /* Messages from the same sender are matched in order, chunk 'idx' lands in place 'idx'. */
+  for (int idx = 0; idx < chunks; ++idx)
+  {
+    int res = MPI_Irecv(&cluster[idx * chunk], chunk_rows(cluster_size, chunk, idx), row_type,
+                        0, MPI::Msg_tag, MPI_COMM_WORLD, &recv_requests[idx]);
+    MPI::exit_on_mpi_failure(res);
+  }
+
+  double compute_time = 0.;
+
+  for (int idx = 0; idx < chunks; ++idx)
+  {
+    int res = MPI_Wait(&recv_requests[idx], MPI_STATUS_IGNORE);
+    MPI::exit_on_mpi_failure(res);
+
+    double compute_start = MPI_Wtime();
+    process_compute(chunk_rows(cluster_size, chunk, idx), &cluster[idx * chunk]);
+    compute_time += MPI_Wtime() - compute_start;
+
+    res = MPI_Isend(&cluster[idx * chunk], chunk_rows(cluster_size, chunk, idx), row_type,
+                    0, MPI::Msg_tag, MPI_COMM_WORLD, &send_requests[idx]);
+    MPI::exit_on_mpi_failure(res);
   }
+
+  int res = MPI_Waitall(chunks, send_requests.data(), MPI_STATUSES_IGNORE);
+  MPI::exit_on_mpi_failure(res);
+
+  return compute_time;
+}
+
+#ifndef QUIET
+/*
+ * Collectively write computation results to the binary file,
+ * every process writes the rows assigned to it as 'row_type' elements.
+ * Use 'field2txt' to convert them to text.
+ */
+void process_write(const DECOMP::offsets& offsets, int rank, MPI_Datatype row_type,
+                   const row* cluster)
+{
+  int cluster_size = offsets[rank + 1] - offsets[rank];
+
+  MPI_File result_file;
+  int res = FIELD::mpi_create(MPI_COMM_WORLD, "result.bin", FIELD::make_header_2d(Isize, Jsize),
+                              &result_file);
+  MPI::exit_on_mpi_failure(res);
+
+  res = FIELD::mpi_write_all(
+    result_file,
+    offsets[rank] * Jsize,
+    cluster,
+    cluster_size,
+    row_type);
+  MPI::exit_on_mpi_failure(res);
+
+  res = FIELD::mpi_close(&result_file);
+  MPI::exit_on_mpi_failure(res);
 }
 #endif /* !QUIET */
 
-void main_process(int comm_size)
+/*
+ * Measure time of the computations of the process and update
+ * the weights of the processes in the file 'balance' for the next run.
+ */
+void process_rebalance(const std::string& balance, const DECOMP::offsets& offsets,
+                       const std::vector<double>& weights, double compute_time)
 {
-  auto array = new row[Isize];
+  std::vector<double> times;
+  int res = DECOMP::mpi_rebalance(MPI_COMM_WORLD, balance, offsets, weights, compute_time, times);
+  MPI::exit_on_mpi_failure(res);
+
+#ifdef TIMING
+  if (!times.empty())
+  {
+    std::clog << "Load imbalance (max / mean compute time): " << DECOMP::imbalance(times) << "\n";
+  }
+#endif
+}
+
+/*
+ * Main process for the zero rank. In the 'scatter' and 'pipeline' modes it fills
+ * the whole array, distributes it and collects the results, in the 'local' mode
+ * it works with its own rows only, as the secondary processes do.
+ */
+void main_process(const run_options& options, const DECOMP::offsets& offsets,
+                  const std::vector<double>& weights, MPI_Datatype row_type)
+{
+  bool whole_array = (options.transfer != transfer_mode::local);
+
+  auto array = new row[whole_array ? Isize : offsets[1]];
 
   /* Preparation - fill array with some data. */
-  main_process_prepare(array);
+  process_prepare(0, whole_array ? Isize : offsets[1], array);
 
 #ifdef TIMING
   MPI::stopwatch sw;
   sw.start();
 #endif
 
-  /* Cluster size - number of rows per process. */
-  int cluster_size = Isize / comm_size;
+  double compute_time = 0.;
 
-  /* Send data for computations to the secondary processes. */
-  for (int rank = 1; rank < comm_size; ++rank)
+  if (options.transfer == transfer_mode::pipeline)
   {
-    main_process_send(cluster_size, rank, array);
+    compute_time = main_process_stream(offsets, options.chunk, row_type, array);
   }
+  else
+  {
+    if (options.transfer == transfer_mode::scatter)
+    {
+      process_scatter(offsets, 0, row_type, array, array);
+    }
 
-  /* Main computations. */
-  process_compute(cluster_size, array);
+    /* Main computations. */
+    double compute_start = MPI_Wtime();
+    process_compute(offsets[1], array);
+    compute_time = MPI_Wtime() - compute_start;
 
-  /* Receive computation results from the secondary processes. */
-  for (int rank = 1; rank < comm_size; ++rank)
-  {
-    main_process_recv(cluster_size, rank, array);
+    if (options.transfer == transfer_mode::scatter)
+    {
+      process_gather(offsets, 0, row_type, array, array);
+    }
+    else
+    {
+      /* Wait for the rest of the processes to complete their rows. */
+      int res = MPI_Barrier(MPI_COMM_WORLD);
+      MPI::exit_on_mpi_failure(res);
+    }
   }
 
 #ifdef TIMING
   std::clog << "Total elapsed: " << sw.stop() << " sec \n";
 #endif
 
+  process_rebalance(options.balance, offsets, weights, compute_time);
+
 #ifndef QUIET
-  main_process_print(array);
+  process_write(offsets, 0, row_type, array);
 #endif
+
+  delete[] array;
 }
 
-void secondary_process_recv(int cluster_size, row* cluster)
+void secondary_process(const run_options& options, const DECOMP::offsets& offsets,
+                       const std::vector<double>& weights, MPI_Datatype row_type, int rank)
 {
-  int res = MPI_Recv(
-    cluster,
-    Jsize * cluster_size,
-    MPI_DOUBLE,
-    0,
-    MPI::Msg_tag,
-    MPI_COMM_WORLD,
-    MPI_STATUS_IGNORE);
-  MPI::exit_on_mpi_failure(res);
+  /* Cluster size - number of rows per process. */
+  int cluster_size = offsets[rank + 1] - offsets[rank];
+
+  /* Allocate memory only for the rows, assigned to the current process. */
+  auto cluster = new row[cluster_size];
+
+  double compute_time = 0.;
+
+  if (options.transfer == transfer_mode::pipeline)
+  {
+    compute_time = secondary_process_stream(cluster_size, options.chunk, row_type, cluster);
+  }
+  else
+  {
+    if (options.transfer == transfer_mode::scatter)
+    {
+      /* Receive data, prepared for the computations, from the main process. */
+      process_scatter(offsets, rank, row_type, nullptr, cluster);
+    }
+    else
+    {
+      /* Fill own rows the same way the main process would. */
+      process_prepare(offsets[rank], cluster_size, cluster);
+    }
+
+    /* Main computations. */
+    double compute_start = MPI_Wtime();
+    process_compute(cluster_size, cluster);
+    compute_time = MPI_Wtime() - compute_start;
+
+    if (options.transfer == transfer_mode::scatter)
+    {
+      /* Send computation results back to the main process. */
+      process_gather(offsets, rank, row_type, cluster, nullptr);
+    }
+    else
+    {
+      int res = MPI_Barrier(MPI_COMM_WORLD);
+      MPI::exit_on_mpi_failure(res);
+    }
+  }
+
+  process_rebalance(options.balance, offsets, weights, compute_time);
+
+#ifndef QUIET
+  process_write(offsets, rank, row_type, cluster);
+#endif
+
+  delete[] cluster;
 }
 
-void secondary_process_send(int cluster_size, const row* cluster)
+/*
+ * Process of the 'shared' mode for all ranks of 'node'. The whole array is the segment
+ * of rank 0 in the shared window, the rest of the processes allocate empty segments
+ * and access the rows of rank 0 directly.
+ */
+void shared_process(const run_options& options, const DECOMP::offsets& offsets,
+                    const std::vector<double>& weights, [[maybe_unused]] MPI_Datatype row_type,
+                    MPI_Comm node, int rank)
 {
-  int res = MPI_Send(cluster, Jsize * cluster_size, MPI_DOUBLE, 0, MPI::Msg_tag, MPI_COMM_WORLD);
+  MPI_Win win;
+  row* array;
+
+  MPI_Aint bytes = (rank == 0) ? MPI_Aint(Isize) * sizeof(row) : 0;
+  int res = SHM::allocate(node, bytes, &win, &array);
   MPI::exit_on_mpi_failure(res);
-}
 
-void secondary_process(int comm_size)
-{
-  /* Cluster size - number of rows per process. */
-  int cluster_size = Isize / comm_size;
+  if (rank != 0)
+  {
+    res = SHM::segment(win, 0, &array);
+    MPI::exit_on_mpi_failure(res);
+  }
+  else
+  {
+    /* Preparation - fill array with some data. */
+    process_prepare(0, Isize, array);
+  }
 
-  /* Allocate memory only for the rows, assigned to the current process. */
-  auto cluster = new row[cluster_size];
+#ifdef TIMING
+  MPI::stopwatch sw;
+  sw.start();
+#endif
 
-  /* Receive data, prepared for the computations, from the main process. */
-  secondary_process_recv(cluster_size, cluster);
+  /* Prepared rows are visible to all processes, the same point the scatter completes at. */
+  res = SHM::sync(win, node);
+  MPI::exit_on_mpi_failure(res);
+
+  int cluster_size = offsets[rank + 1] - offsets[rank];
+  row* cluster = &array[offsets[rank]];
 
   /* Main computations. */
+  double compute_start = MPI_Wtime();
   process_compute(cluster_size, cluster);
+  double compute_time = MPI_Wtime() - compute_start;
+
+  /* Computed rows are visible to rank 0, the same point the gather completes at. */
+  res = SHM::sync(win, node);
+  MPI::exit_on_mpi_failure(res);
+
+#ifdef TIMING
+  if (rank == 0)
+  {
+    std::clog << "Total elapsed: " << sw.stop() << " sec \n";
+  }
+#endif
+
+  process_rebalance(options.balance, offsets, weights, compute_time);
+
+#ifndef QUIET
+  process_write(offsets, rank, row_type, cluster);
+#endif
 
-  /* Send computation results back to the main process. */
-  secondary_process_send(cluster_size, cluster);
+  res = SHM::free_window(&win);
+  MPI::exit_on_mpi_failure(res);
 }
 
 } /* anonymous namespace */
@@ -181,28 +564,95 @@ int main(int argc, char** argv)
   res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   MPI::exit_on_mpi_failure(res);
 
-  /* Number of rows must be divisible by number of secondary processes. */
-  if (Isize % comm_size != 0)
+  run_options options;
+
+  try
+  {
+    options = parse_options(argc, argv);
+  }
+  catch (const std::logic_error& exc)
+  {
+    if (rank == 0)
+    {
+      std::cerr << "Invalid options: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    }
+    return EXIT_FAILURE;
+  }
+
+  /*
+   * Optional file with the weights of the processes. Rows are split proportionally
+   * to the weights, the file is updated from the measured times after the run.
+   * Without it rows are split evenly, first 'Isize % comm_size' processes get one row more.
+   */
+  std::vector<double> weights;
+  res = DECOMP::mpi_load_weights(MPI_COMM_WORLD, options.balance, weights);
+  MPI::exit_on_mpi_failure(res);
+
+  DECOMP::offsets offsets;
+
+  try
+  {
+    offsets = DECOMP::weighted_offsets(Isize, weights);
+  }
+  catch (const std::invalid_argument& exc)
   {
     if (rank == 0)
     {
       std::cerr << "Total number of rows " << Isize << " cannot be divided among " << comm_size
-                << "nodes.\n";
+                << " nodes: " << exc.what() << "\n";
     }
     return EXIT_FAILURE;
   }
 
-  if (rank == 0)
+  /* Rows are the elements of all messages, so that counts fit into int. */
+  MPI_Datatype row_type;
+  res = MPI_Type_contiguous(Jsize, MPI_DOUBLE, &row_type);
+  MPI::exit_on_mpi_failure(res);
+
+  res = MPI_Type_commit(&row_type);
+  MPI::exit_on_mpi_failure(res);
+
+  /* Processes of the 'shared' mode, MPI_COMM_NULL if they are not on one node. */
+  MPI_Comm node = MPI_COMM_NULL;
+
+  if (options.transfer == transfer_mode::shared)
+  {
+    res = SHM::single_node_comm(MPI_COMM_WORLD, &node);
+    MPI::exit_on_mpi_failure(res);
+
+    if (node == MPI_COMM_NULL)
+    {
+      if (rank == 0)
+      {
+        std::cerr << "Not all processes share memory, falling back to the scatter transfer\n";
+      }
+      options.transfer = transfer_mode::scatter;
+    }
+  }
+
+  if (node != MPI_COMM_NULL)
+  {
+    /* Same process for all ranks, rows are not sent. */
+    shared_process(options, offsets, weights, row_type, node, rank);
+
+    res = MPI_Comm_free(&node);
+    MPI::exit_on_mpi_failure(res);
+  }
+  else if (rank == 0)
   {
     /* Main process for the zero rank. */
-    main_process(comm_size);
+    main_process(options, offsets, weights, row_type);
   }
   else
   {
     /* Secondary process for all other ranks. */
-    secondary_process(comm_size);
+    secondary_process(options, offsets, weights, row_type, rank);
   }
 
+  res = MPI_Type_free(&row_type);
+  MPI::exit_on_mpi_failure(res);
+
   /* Impiclit MPI env finalization via 'MPI_env' dtor. */
   return 0;
 }
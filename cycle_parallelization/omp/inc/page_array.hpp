@@ -0,0 +1,84 @@
+#ifndef PAGE_ARRAY_HPP
+#define PAGE_ARRAY_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/mman.h>
+
+namespace UTILS
+{
+
+/* Size of the transparent huge page on x86-64. */
+constexpr size_t Huge_page_size = 2U << 20;
+
+/*
+ * Array of 'count' elements of trivial type 'T' mapped directly from the system.
+ * Pages are not touched on allocation, so each of them is placed on the NUMA node
+ * of the thread writing it first: arrays are to be initialized in parallel with
+ * the same schedule as the computations. With 'huge' the mapping is aligned
+ * to 2 MB and advised to be backed by the transparent huge pages.
+ */
+template <typename T>
+class page_array
+{
+  void* map_ = MAP_FAILED;
+  size_t map_size_ = 0;
+
+  T* data_ = nullptr;
+  bool huge_ = false;
+
+public:
+  /* Throws std::system_error if the memory cannot be mapped. */
+  page_array(size_t count, bool huge)
+  {
+    size_t size = count * sizeof(T);
+    map_size_ = huge ? size + Huge_page_size : size;
+
+    map_ = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map_ == MAP_FAILED)
+    {
+      throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(map_);
+
+    if (huge)
+    {
+      begin = (begin + Huge_page_size - 1) & ~(Huge_page_size - 1);
+
+      /* Huge pages may be disabled in the system, then the usual ones are kept. */
+      huge_ = (::madvise(reinterpret_cast<void*>(begin), size, MADV_HUGEPAGE) == 0);
+    }
+
+    data_ = reinterpret_cast<T*>(begin);
+  }
+
+  page_array(const page_array&) = delete;
+  page_array& operator=(const page_array&) = delete;
+
+  ~page_array()
+  {
+    if (map_ != MAP_FAILED)
+    {
+      ::munmap(map_, map_size_);
+    }
+  }
+
+  T* data() const noexcept
+  {
+    return data_;
+  }
+
+  /* Huge pages were requested and accepted by the system. */
+  bool huge_pages() const noexcept
+  {
+    return huge_;
+  }
+};
+
+} /* namespace UTILS */
+
+#endif /* PAGE_ARRAY_HPP */
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vec_sin.hpp"
+
+/*
+ * Accuracy and speed of the sine kernels against libm.
+ * Arguments are taken as in task01: sin(2 * a) for a = 10 * i + j,
+ * and uniformly from the whole reduction range. Errors are measured
+ * against 'sinl', time is the best of 'Reps' passes over the arguments.
+ */
+
+namespace
+{
+const unsigned Reps = 5U;
+
+/* Number of the arguments of each set. */
+const size_t Count = 1U << 22;
+
+struct errors
+{
+  double max_abs = 0.;
+  double max_ulp = 0.;
+};
+
+/* Error of the computed values, 'args' are the arguments before scaling by 2. */
+errors measure_errors(const std::vector<double>& args, const std::vector<double>& values)
+{
+  errors result;
+
+  for (size_t idx = 0; idx < args.size(); ++idx)
+  {
+    long double exact = sinl(2.L * args[idx]);
+    double rounded = static_cast<double>(exact);
+
+    double ulp = std::nextafter(std::abs(rounded), INFINITY) - std::abs(rounded);
+    double abs_err = static_cast<double>(std::abs(values[idx] - exact));
+
+    result.max_abs = std::max(result.max_abs, abs_err);
+    result.max_ulp = std::max(result.max_ulp, abs_err / ulp);
+  }
+
+  return result;
+}
+
+template <VMATH::accuracy A>
+double measure_time(const std::vector<double>& args, std::vector<double>& values)
+{
+  double best = 0.;
+
+  for (unsigned rep = 0; rep < Reps; ++rep)
+  {
+    std::copy(args.begin(), args.end(), values.begin());
+
+    auto start_time = std::chrono::steady_clock::now();
+    VMATH::sin_scaled<A>(values.data(), values.size(), 2.);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+    best = (rep == 0) ? elapsed.count() : std::min(best, elapsed.count());
+  }
+
+  return best;
+}
+
+template <VMATH::accuracy A>
+void report(const std::string& name, const std::vector<double>& args, double libm_time)
+{
+  std::vector<double> values(args.size());
+
+  double time = measure_time<A>(args, values);
+  errors err = measure_errors(args, values);
+
+  std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << 1e9 * time / args.size() << " ns"
+            << std::setw(10) << ((libm_time > 0.) ? libm_time / time : 1.) << "x"
+            << std::scientific << std::setw(14) << err.max_abs << std::defaultfloat
+            << std::setprecision(3) << std::setw(12) << err.max_ulp << "\n";
+}
+
+void report_set(const std::string& title, const std::vector<double>& args)
+{
+  std::cout << title << "\n"
+            << std::left << std::setw(10) << "kernel" << std::right << std::setw(13) << "time"
+            << std::setw(11) << "speedup" << std::setw(14) << "max abs err" << std::setw(12)
+            << "max ulp" << "\n";
+
+  std::vector<double> values(args.size());
+  double libm_time = measure_time<VMATH::accuracy::libm>(args, values);
+
+  report<VMATH::accuracy::libm>("libm", args, 0.);
+  report<VMATH::accuracy::precise>("precise", args, libm_time);
+  report<VMATH::accuracy::fast>("fast", args, libm_time);
+
+  std::cout << "\n";
+}
+} /* anonymous namespace */
+
+int main()
+{
+  std::mt19937_64 gen(42);
+
+  /* Array values of task01, a[i][j] = 10 * i + j. */
+  std::uniform_int_distribution<int> index(0, 39999);
+  std::vector<double> task_args(Count);
+
+  for (auto& arg : task_args)
+  {
+    arg = 10 * index(gen) + index(gen);
+  }
+
+  /* Whole range of the polynomial kernels. */
+  std::uniform_real_distribution<double> range(-VMATH::reduction_limit / 2, VMATH::reduction_limit / 2);
+  std::vector<double> range_args(Count);
+
+  for (auto& arg : range_args)
+  {
+    arg = range(gen);
+  }
+
+  std::cout << "Values per set: " << Count << ", time per value is the best of " << Reps
+            << " runs\n\n";
+
+  report_set("task01 arguments, sin(2 * (10 * i + j))", task_args);
+  report_set("uniform arguments in (-1.6e6; 1.6e6)", range_args);
+
+  return EXIT_SUCCESS;
+}
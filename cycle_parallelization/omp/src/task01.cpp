@@ -1,71 +1,104 @@
 #include <cmath>
 
-#ifdef TIMING
+#include "vec_sin.hpp"
+#include "page_array.hpp"
+
 #include <iostream>
-#include "stopwatch.hpp"
-#endif
+#include "timing.hpp"
 
 #ifndef QUIET
-#include <fstream>
-#include <cassert>
+#include <cstring>
+#include "field_mmap.hpp"
 #endif
 
 namespace
 {
-/* Array dimensions. */
-const int Isize = 40000;
-const int Jsize = 40000;
+/* Array dimensions, may be changed with the 'ISIZE' and 'JSIZE' build options. */
+#ifndef ISIZE
+#define ISIZE 40000
+#endif
+
+#ifndef JSIZE
+#define JSIZE 40000
+#endif
+
+const int Isize = ISIZE;
+const int Jsize = JSIZE;
 
 using row = double[Jsize];
+
+/* Back the array with the transparent huge pages, set with the 'HUGE_PAGES' build option. */
+#ifdef HUGE_PAGES
+const bool Huge_pages = true;
+#else
+const bool Huge_pages = false;
+#endif
+
+/* Time is reported by default with the 'TIMING' build option, 'PP_TIMING' overrides it at run time. */
+#ifdef TIMING
+const UTILS::timing_mode Timing_default = UTILS::timing_mode::on;
+#else
+const UTILS::timing_mode Timing_default = UTILS::timing_mode::off;
+#endif
 } /* anonymous namespace */
 
 int main()
 {
-  auto a = new row[Isize];
+  UTILS::page_array<row> storage(Isize, Huge_pages);
+  row* a = storage.data();
 
-  /* Preparation - fill array with some data. */
-  for (int i = 0; i < Isize; ++i)
+  /* Created before the threads, so that the hardware counters are inherited by them. */
+  UTILS::timing_report timing(UTILS::timing_mode_from_env(Timing_default));
+
+  /*
+   * Preparation - fill array with some data. Rows are shared between threads
+   * as in the computational cycle, so that each page is first touched and
+   * placed on the NUMA node by the thread which is to compute it.
+   */
   {
-    for (int j = 0; j < Jsize; ++j)
+    UTILS::timing_report::scope region(timing, "init");
+
+#pragma omp parallel default(none) shared(a)
+#pragma omp for schedule(static)
+    for (int i = 0; i < Isize; ++i)
     {
-      a[i][j] = 10 * i + j;
+      for (int j = 0; j < Jsize; ++j)
+      {
+        a[i][j] = 10 * i + j;
+      }
     }
   }
 
-#ifdef TIMING
-  UTILS::stopwatch sw;
-  sw.start();
-#endif
+  /* Main computational cycle. */
+  {
+    UTILS::timing_report::scope region(timing, "compute");
 
-/* Main computational cycle. */
 #pragma omp parallel default(none) shared(a)
 #pragma omp for schedule(static)
-  for (int i = 0; i < Isize; ++i)
-  {
-    for (int j = 0; j < Jsize; ++j)
+    for (int i = 0; i < Isize; ++i)
     {
-      a[i][j] = sin(2 * a[i][j]);
+      /* a[i][j] = sin(2 * a[i][j]), vectorized kernel of the accuracy chosen by 'SIN_ACCURACY'. */
+      VMATH::sin_scaled(a[i], Jsize, 2.);
     }
   }
 
-#ifdef TIMING
-  std::clog << "Total elapsed: " << sw.stop() << " sec \n";
-#endif
+  if (timing.enabled())
+  {
+    std::clog << "Init elapsed: " << timing.total("init") << " sec"
+              << (storage.huge_pages() ? " (huge pages)" : "") << "\n";
+    std::clog << "Total elapsed: " << timing.total("compute") << " sec \n";
+    timing.print(std::clog);
+  }
 
 #ifndef QUIET
-  auto result_file = std::ofstream("result.txt");
-  assert(result_file.is_open());
+  /* Results are stored in binary form, use 'field2txt' to convert them to text. */
+  FIELD::mapped_writer result_file("result.bin", FIELD::make_header_2d(Isize, Jsize));
 
+#pragma omp parallel default(none) shared(a, result_file)
+#pragma omp for schedule(static)
   for (int i = 0; i < Isize; ++i)
   {
-    for (int j = 0; j < Jsize; ++j)
-    {
-      result_file << a[i][j] << ' ';
-    }
-
-    result_file << std::endl;
+    std::memcpy(result_file.row(i), a[i], Jsize * sizeof(double));
   }
 #endif /* !QUIET */
-
-  delete[] a;
 }
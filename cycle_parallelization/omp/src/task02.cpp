@@ -1,98 +1,179 @@
+#include <algorithm>
 #include <cmath>
 
-#ifdef TIMING
+#include "page_array.hpp"
+
 #include <iostream>
-#include "stopwatch.hpp"
-#endif
+#include "timing.hpp"
 
 #ifndef QUIET
-#include <fstream>
-#include <cassert>
+#include <cstring>
+#include "field_mmap.hpp"
 #endif
 
 namespace
 {
-/* Array dimensions. */
-const int Isize = 40000;
-const int Jsize = 40000;
+/* Array dimensions, may be changed with the 'ISIZE' and 'JSIZE' build options. */
+#ifndef ISIZE
+#define ISIZE 40000
+#endif
 
-using row = double[Jsize + 3];
-} /* anonymous namespace */
+#ifndef JSIZE
+#define JSIZE 40000
+#endif
 
-int main()
-{
-  auto a = new row[Isize];
+const int Isize = ISIZE;
+const int Jsize = JSIZE;
 
-  /* Preparation - fill array with some data. */
-  for (int i = 0; i < Isize; ++i)
-  {
-    for (int j = 0; j < Jsize; ++j)
-    {
-      a[i][j] = 10 * i + j;
-    }
-  }
+using row = double[Jsize + 3];
+
+/* Back the array with the transparent huge pages, set with the 'HUGE_PAGES' build option. */
+#ifdef HUGE_PAGES
+const bool Huge_pages = true;
+#else
+const bool Huge_pages = false;
+#endif
 
+/* Time is reported by default with the 'TIMING' build option, 'PP_TIMING' overrides it at run time. */
 #ifdef TIMING
-  UTILS::stopwatch sw;
-  sw.start();
+const UTILS::timing_mode Timing_default = UTILS::timing_mode::on;
+#else
+const UTILS::timing_mode Timing_default = UTILS::timing_mode::off;
 #endif
 
-  /* Duplicate data for extra columns. */
-  for (int i = 0; i < Isize; ++i)
+/*
+ * Width of the tile in the skewed columns. Tile keeps the segments of
+ * the current rows and of the rows two above in the L1 cache.
+ */
+const int Tile_cols = 512;
+
+/*
+ * Column shift between the rows of the same parity. Element a[i][c] depends
+ * only on a[i - 2][c + 3], so rows of different parity are independent and
+ * in skewed columns c + Skew * s, where s = (i - 2) / 2, the dependence
+ * becomes a[s][c'] <- a[s - 1][c'].
+ */
+const int Skew = 3;
+
+/*
+ * Compute rows i >= 4 inside the strip of skewed columns [first; last).
+ * Strip of both row parities depends only on itself, so strips are
+ * computed independently and without synchronization. Each row reads
+ * the segment of the row two above, which has just been written.
+ */
+void compute_strip(row* a, int first, int last)
+{
+  /* Earlier steps lie to the right of the array. */
+  int s_first = std::max(1, (first - Jsize) / Skew);
+
+  for (int s = s_first; 2 + 2 * s < Isize; ++s)
   {
-    for (int j = Jsize; j < Jsize + 3; ++j)
+    /* Columns of the strip in the rows of this step. */
+    int c_begin = std::max(3, first - Skew * s);
+    int c_end = std::min(Jsize, last - Skew * s);
+
+    if (c_end <= 3)
     {
-      a[i][j] = a[i][j - 3];
+      break;
     }
-  }
 
-  /* Main computations. */
-  for (int i = 2; i < 4; ++i)
-  {
-    for (int j = 0; j < Jsize - 3; ++j)
+    for (int i = 2 + 2 * s; i < std::min(4 + 2 * s, Isize); ++i)
     {
-      a[i][j + 3] = 2 * a[i - 2][j + 3];
+      for (int c = c_begin; c < c_end; ++c)
+      {
+        a[i][c] = sin(5 * a[i - 2][c + 3]);
+      }
     }
   }
+}
+} /* anonymous namespace */
+
+int main()
+{
+  UTILS::page_array<row> storage(Isize, Huge_pages);
+  row* a = storage.data();
 
-  for (int i = 4; i < Isize; ++i)
+  /* Created before the threads, so that the hardware counters are inherited by them. */
+  UTILS::timing_report timing(UTILS::timing_mode_from_env(Timing_default));
+
+  /*
+   * Preparation - fill array with some data. Strips are scheduled dynamically
+   * and have no fixed owner, so pages are spread evenly between the threads
+   * by rows, with the same schedule as the duplication of the extra columns below.
+   */
   {
-    #pragma omp parallel default(none) shared(a, i)
-    #pragma omp for
-    for (int j = 0; j < Jsize - 3; ++j)
+    UTILS::timing_report::scope region(timing, "init");
+
+#pragma omp parallel default(none) shared(a)
+#pragma omp for schedule(static)
+    for (int i = 0; i < Isize; ++i)
     {
-      a[i][j + 3] = sin(5 * a[i - 2][j + 6]);
+      for (int j = 0; j < Jsize; ++j)
+      {
+        a[i][j] = 10 * i + j;
+      }
     }
   }
 
-#ifdef TIMING
-  std::clog << "Total elapsed: " << sw.stop() << " sec \n";
-#endif
-
-#ifndef QUIET
-  auto result_file = std::ofstream("result.txt");
-  assert(result_file.is_open());
+  /* Strips of the skewed columns, the last row is shifted by Skew * s_max. */
+  const int strips = (Jsize + Skew * ((Isize - 1) / 2) + Tile_cols - 1) / Tile_cols;
 
-  for (int i = 0; i < 2; ++i)
   {
-    for (int j = 0; j < Jsize; ++j)
+    UTILS::timing_report::scope region(timing, "compute");
+
+    /* Single parallel region for the whole computation. */
+#pragma omp parallel default(none) shared(a)
     {
-      result_file << a[i][j] << ' ';
+      /* Duplicate data for extra columns. */
+#pragma omp for schedule(static)
+      for (int i = 0; i < Isize; ++i)
+      {
+        for (int j = Jsize; j < Jsize + 3; ++j)
+        {
+          a[i][j] = a[i][j - 3];
+        }
+      }
+
+      /* Main computations. */
+#pragma omp for schedule(static)
+      for (int j = 0; j < Jsize - 3; ++j)
+      {
+        for (int i = 2; i < 4; ++i)
+        {
+          a[i][j + 3] = 2 * a[i - 2][j + 3];
+        }
+      }
+
+      /*
+       * Rows i >= 4: a[i][j + 3] = sin(5 * a[i - 2][j + 6]). Strips near the ends
+       * of the skewed range hold less work, so they are scheduled dynamically.
+       */
+#pragma omp for schedule(dynamic)
+      for (int strip = 0; strip < strips; ++strip)
+      {
+        compute_strip(a, strip * Tile_cols, (strip + 1) * Tile_cols);
+      }
     }
-
-    result_file << std::endl;
   }
 
-  for (int i = 2; i < Isize; ++i)
+  if (timing.enabled())
   {
-    for (int j = 3; j < Jsize + 3; ++j)
-    {
-      result_file << a[i][j] << ' ';
-    }
+    std::clog << "Init elapsed: " << timing.total("init") << " sec"
+              << (storage.huge_pages() ? " (huge pages)" : "") << "\n";
+    std::clog << "Total elapsed: " << timing.total("compute") << " sec \n";
+    timing.print(std::clog);
+  }
 
-    result_file << std::endl;
+#ifndef QUIET
+  /* Results are stored in binary form, use 'field2txt' to convert them to text. */
+  FIELD::mapped_writer result_file("result.bin", FIELD::make_header_2d(Isize, Jsize));
+
+  /* First two rows are stored as is, the rest are shifted by three columns. */
+#pragma omp parallel default(none) shared(a, result_file)
+#pragma omp for schedule(static)
+  for (int i = 0; i < Isize; ++i)
+  {
+    std::memcpy(result_file.row(i), (i < 2) ? a[i] : a[i] + 3, Jsize * sizeof(double));
   }
 #endif /* !QUIET */
-
-  delete[] a;
 }
@@ -1,6 +1,7 @@
 #ifndef GLOBAL_STACK_HPP 
 #define GLOBAL_STACK_HPP
 
+#include <cmath>
 #include <thread>
 #include <stack>
 #include <mutex>
@@ -8,8 +9,88 @@
 #include <semaphore>
 #include <functional>
 
+#include "timing.hpp"
+
 namespace GSTACK {
 
+/* Period of the integration */
+struct Entry {
+
+  double A;   // left bound
+  double B;   // right bound
+  double fA;  // f(A)
+  double fB;  // f(B)
+  double sAB; // approx. integral value on period [A;B]
+};
+
+using Stack = std::stack<Entry>;
+
+/* Period [A;B] with the trapezoid approximation of the integral */
+template <typename Function>
+Entry make_entry(const Function& function, double A, double B) {
+
+  double fA = function(A);
+  double fB = function(B);
+
+  return Entry{A, B, fA, fB, (fA + fB) * (B - A) / 2};
+}
+
+/*
+ * Local stack algorithm of the adaptive trapezoid rule, shared by the
+ * application threads of the integrator and the sequential quadrature.
+ * The period is halved until the relative difference of the approximations
+ * is less than 'eps', integral of each final period is passed to 'accept'.
+ * 'step' is called with the local stack after every halving or pop,
+ * the global stack algorithm moves the entries to the global stack there.
+ */
+template <typename Function, typename Accept, typename Step>
+void integrate_local_stack(const Function& function, Entry entry, double eps,
+                           Accept&& accept, Step&& step) {
+
+  /* Local stack */
+  Stack lstack;
+
+  while (true) {
+
+    double C  = (entry.A + entry.B) / 2;
+    double fC = function(C);
+
+    double sAC = (entry.fA + fC) * (C - entry.A) / 2;
+    double sCB = (entry.fB + fC) * (entry.B - C) / 2;
+
+    double sACB = sAC + sCB;
+
+    /* 
+     * Desired accuracy is succeded or the period can not be halved any more,
+     * otherwise periods with zero integral value would be halved endlessly
+     */
+    if (std::abs(entry.sAB - sACB) < eps * std::abs(sACB) || C <= entry.A || C >= entry.B) {
+
+      accept(sACB);
+
+      /* Nothing to integrate in local stack, break */
+      if (lstack.empty()) {
+        break;
+      }
+
+      /* Else obtain another entry from local stack */
+      entry = lstack.top();
+      lstack.pop();
+
+    } else { 
+
+      /* Push [A;C], entry now is [C;B] */
+      lstack.push(Entry{entry.A, C, entry.fA, fC, sAC});
+
+      entry.A   = C;
+      entry.fA  = fC;
+      entry.sAB = sCB;
+    }
+
+    step(lstack);
+  }
+}
+
 class Gstack_integrator {
 
 public:
@@ -22,7 +103,7 @@ private:
   /* Precision of double comparison */
   static constexpr double Precision = 1E-9;
 
-  /* Precision for break condition of integration */
+  /* Default precision for break condition of integration */
   static constexpr double Eps = 1E-6;
 
   /* 
@@ -33,30 +114,25 @@ private:
    */
   static constexpr unsigned int Max_local_sp = 8;
 
-  struct Entry {
-
-    double A;   // left bound
-    double B;   // right bound
-    double fA;  // f(A)
-    double fB;  // f(B)
-    double sAB; // approx. integral value on period [A;B]
-  };
-
   /* Integrated function */
   function function_m;
 
   /* Boundaries of the integral */
   std::pair<double, double> bound_m;
 
-  /* Number of aplication threads */
+  /* Default number of aplication threads */
   static const unsigned int Appl_threads_num;
 
+  /* Number of aplication threads of this integrator */
+  unsigned int threads_num_m;
+
+  /* Relative precision for break condition of integration */
+  double eps_m = Eps;
+
   /* Application thread main function */
   using appl_thread_function_t = std::function<void(void)>;
   appl_thread_function_t appl_thread_func;
 
-  using Stack = std::stack<Entry>;
-  
   /* Global stack with periods of integration */
   Stack gstack;
 
@@ -78,22 +154,32 @@ private:
   /* Access to result value of the integral */
   std::mutex mtx_integral_value;
 
-#if defined(VERBOSE) || defined(TIME)
   /* IO mutex */
   std::mutex mtx_io;
+
+  /* Time is reported by default with the 'TIME' build option, 'PP_TIMING' overrides it */
+#ifdef TIME
+  static constexpr UTILS::timing_mode Timing_default = UTILS::timing_mode::on;
+#else
+  static constexpr UTILS::timing_mode Timing_default = UTILS::timing_mode::off;
 #endif
 
+  /* Time of the integration, of the threads and of the periods taken from the global stack */
+  UTILS::timing_report timing_m{UTILS::timing_mode_from_env(Timing_default)};
+
 public:
 
-  Gstack_integrator(function function, std::pair<double, double> bound):
+  Gstack_integrator(function function, std::pair<double, double> bound, 
+                    unsigned int threads_num = Appl_threads_num):
     function_m(function),
     bound_m(bound),
+    threads_num_m(threads_num),
     appl_thread_func(std::bind(&Gstack_integrator::appl_thread_function, this)) 
     {}
 
   virtual ~Gstack_integrator() {}
 
-  /* Getters: integrated function and boundaries */
+  /* Getters: integrated function, boundaries, threads and precision */
 
   function get_function() const { return function_m; }
   std::pair<double, double> get_bound() const { return bound_m; }
@@ -101,7 +187,10 @@ public:
   double get_bound_left()  const { return bound_m.first;  }
   double get_bound_right() const { return bound_m.second; }
 
-  /* Setters: integrated function and boundaries */
+  unsigned int get_threads_num() const { return threads_num_m; }
+  double get_eps() const { return eps_m; }
+
+  /* Setters: integrated function, boundaries, threads and precision */
 
   void set_function(function function) {
     function_m = function;
@@ -111,6 +200,14 @@ public:
     bound_m = bound;
   }
 
+  void set_threads_num(unsigned int threads_num) {
+    threads_num_m = threads_num;
+  }
+
+  void set_eps(double eps) {
+    eps_m = eps;
+  }
+
   /* Calculate integral  */
   void integrate();
 
@@ -121,6 +218,9 @@ public:
    */
   double res() const { return integral_value; }
 
+  /* Measured regions, enabled with the 'TIME' build option or 'PP_TIMING' */
+  UTILS::timing_report& timing() { return timing_m; }
+
 private:
 
   /* Application thread main function */
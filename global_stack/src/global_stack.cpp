@@ -31,28 +31,18 @@ namespace GSTACK {
 
 void Gstack_integrator::integrate() {
   
-#ifdef TIME
-  auto start_time = std::chrono::steady_clock::now();
-#endif
+  /* Hardware counters are read for the whole integration including all threads */
+  UTILS::timing_report::scope region(timing_m, "integrate");
+
+  UTILS::stopwatch sw;
+  sw.start();
 
-  double A   = bound_m.first;
-  double B   = bound_m.second;
-  double fA  = function_m(A);
-  double fB  = function_m(B);
-  double sAB = (fA + fB) * (B - A) / 2;
+  Entry initial_entry = make_entry(function_m, bound_m.first, bound_m.second);
 
 #ifdef VERBOSE
-  std::clog << "Integration [" << A << ";" << B << "] started \n";
+  std::clog << "Integration [" << initial_entry.A << ";" << initial_entry.B << "] started \n";
 #endif
 
-  Entry initial_entry = {
-    .A   = A,
-    .B   = B,
-    .fA  = fA,
-    .fB  = fB,
-    .sAB = sAB
-  };
-
   /* Initialize global stack with initial entry */
   gstack.push(initial_entry);
 
@@ -63,12 +53,12 @@ void Gstack_integrator::integrate() {
   sem_task_present.release();
 
 #ifdef VERBOSE
-  std::clog << "Running " << Appl_threads_num << " application threads.\n";
+  std::clog << "Running " << threads_num_m << " application threads.\n";
 #endif
 
   /* Startup application threads */
   for (unsigned int thread_idx = 0; 
-                    thread_idx < Appl_threads_num;
+                    thread_idx < threads_num_m;
                     thread_idx++) {
 
     tvec.push_back(std::thread(appl_thread_func));
@@ -79,23 +69,15 @@ void Gstack_integrator::integrate() {
     thread->join();
   }
 
-#ifdef TIME
-
-  auto stop_time = std::chrono::steady_clock::now();
-  auto elapsed 
-    = std::chrono::duration_cast<std::chrono::milliseconds> (stop_time - start_time).count();
-
-  std::clog << "Total elapsed: " << elapsed / 1000. << " sec \n";
-
-#endif
+  if (timing_m.enabled()) {
+    std::clog << "Total elapsed: " << sw.stop() << " sec \n";
+  }
 
 }
 
 void Gstack_integrator::appl_thread_function() {
 
-#ifdef TIME
-  uint64_t elapsed{0};
-#endif
+  int64_t elapsed_ns{0};
 
   double integral_value_local = 0;
 
@@ -122,9 +104,8 @@ void Gstack_integrator::appl_thread_function() {
      * will be measured too.   
      */
 
-#ifdef TIME
-    auto start_time = std::chrono::steady_clock::now();
-#endif 
+    UTILS::stopwatch sw;
+    sw.start();
 
     /* Integrate another period locally */
     integrate_local(entry, integral_value_local);
@@ -132,11 +113,10 @@ void Gstack_integrator::appl_thread_function() {
     /* Try-populate gstack with terminal periods */
     populate_gstack_terminal();
 
-#ifdef TIME
-    auto stop_time = std::chrono::steady_clock::now();
-    elapsed += 
-      std::chrono::duration_cast<std::chrono::milliseconds> (stop_time - start_time).count();
-#endif 
+    /* Each period taken from the global stack is a sample of the region */
+    int64_t period_ns = sw.elapsed_ns();
+    timing_m.add("period", period_ns);
+    elapsed_ns += period_ns;
   }
 
   {
@@ -145,19 +125,20 @@ void Gstack_integrator::appl_thread_function() {
     integral_value += integral_value_local;
   }
 
-#ifdef TIME
-  {
+  timing_m.add("thread", elapsed_ns);
+
+  if (timing_m.enabled()) {
+
     std::lock_guard<std::mutex> io_guard(mtx_io);
 
     std::clog << "T #" << std::this_thread::get_id() << std::endl;
-    std::clog << "Elapsed: " << elapsed / 1000. << " sec \n";
+    std::clog << "Elapsed: " << elapsed_ns * 1e-9 << " sec \n";
     std::clog << "-----" << std::endl;
   }
-#endif
 
 }
 
-Gstack_integrator::Entry Gstack_integrator::get_entry_from_gstack() {
+Entry Gstack_integrator::get_entry_from_gstack() {
 
   /* Wait for the entries in global stack to appear */
   sem_task_present.acquire();
@@ -188,54 +169,16 @@ Gstack_integrator::Entry Gstack_integrator::get_entry_from_gstack() {
 
 void Gstack_integrator::integrate_local(Entry entry, double& integral_value_local) {
 
-  /* Local stack */
-  Stack lstack;
-
-  while (true) {
+  VERBOSE_PRINT("Integrating period localy");
 
-    VERBOSE_PRINT("Integrating period localy");
-
-    double C  = (entry.A + entry.B) / 2;
-    double fC = function_m(C);
-
-    double sAC = (entry.fA + fC) * (C - entry.A) / 2;
-    double sCB = (entry.fB + fC) * (entry.B - C) / 2;
-
-    double sACB = sAC + sCB;
-
-    /* Desired accuracy is succeded*/
-    if (std::abs(entry.sAB - sACB) < Eps * std::abs(sACB)) {
-
-      VERBOSE_PRINT("Precision on period succeded"); 
-      integral_value_local += sACB;
-
-      /* Nothing to integrate in local stack, break */
-      if (lstack.empty()) {
-
-        VERBOSE_PRINT("Local stack is empty, stop");
-        break;
-      }
-
-      /* Else obtain another entry from local stack */
-      entry = lstack.top();
-      lstack.pop();
-
-      VERBOSE_PRINT("Obtained new entry from lstack");
-
-    } else { 
-
-      /* Push [A;C] */
-      lstack.push(Entry{entry.A, C, entry.fA, fC, sAC});
-      VERBOSE_PRINT("Pushed period to local stack");
-
-      /* entry now is [C;B] */
-      entry.A   = C;
-      entry.fA  = fC;
-      entry.sAB = sCB;
-    }
-
-    populate_gstack(lstack);
-  }
+  integrate_local_stack(function_m, entry, eps_m,
+    [&](double value) {
+      VERBOSE_PRINT("Precision on period succeded");
+      integral_value_local += value;
+    },
+    [this](Stack& lstack) {
+      populate_gstack(lstack);
+    });
 }
 
 void Gstack_integrator::populate_gstack(Stack& lstack) {
@@ -296,7 +239,7 @@ void Gstack_integrator::populate_gstack_terminal() {
    * stop them all
    */
   for (unsigned int thread_idx = 0; 
-                  thread_idx < Appl_threads_num;
+                  thread_idx < threads_num_m;
                   thread_idx++) {
 
     gstack.push(terminal_entry);
@@ -1,19 +1,50 @@
 #include <iostream>
 #include <cmath>
 #include <chrono>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
 
 #include "global_stack.hpp"
 using namespace GSTACK;
 
-int main() {
+int main(int argc, char** argv) {
 
   Gstack_integrator::function func = [](double x) -> double { return std::sin(1./x); };
   std::pair<double, double> bound = std::make_pair(1E-5, 1.);
 
   Gstack_integrator integrator{func, bound};
-  
+
+  /*
+   * Optional number of application threads and left bound of the integral,
+   * the closer the bound to zero, the more periods there are to integrate
+   */
+  try {
+
+    if (argc > 1) {
+      integrator.set_threads_num(std::stoul(argv[1]));
+    }
+
+    if (argc > 2) {
+      integrator.set_bound(std::make_pair(std::stod(argv[2]), 1.));
+    }
+
+    if (integrator.get_threads_num() == 0 || !(integrator.get_bound_left() > 0)
+                                          || integrator.get_bound_left() >= 1.) {
+      throw std::invalid_argument("threads must be positive, left bound must be in (0; 1)");
+    }
+
+  } catch (const std::logic_error& exc) {
+
+    std::cerr << "Invalid arguments: " << exc.what() << "\n";
+    std::cerr << "Usage: " << argv[0] << " [<threads> [<left bound>]]\n";
+    return EXIT_FAILURE;
+  }
+
   integrator.integrate();
   std::cout << "Integrator result: " << integrator.res() << std::endl;
 
+  integrator.timing().print(std::clog);
+
   return 0;
-}
\ No newline at end of file
+}
@@ -1,87 +1,289 @@
+#include <cmath>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <omp.h>
 
 #include "mpi.h"
 #include "mpi_support.hpp"
+#include "decomposition.hpp"
+#include "comp_sum.hpp"
+
+static const unsigned long long Default_nbin = 10000000000U;
+
+/* Partial sums of the bins are accumulated in long double with the compensation */
+using Comp_sum = UTILS::comp_sum<long double>;
+
+/* User-defined reduction operation: inout[i] = in[i] + inout[i] keeping the compensation */
+static void comp_sum_op(void* in, void* inout, int* len, MPI_Datatype* /* datatype */) {
+
+  Comp_sum* in_sums = static_cast<Comp_sum*>(in);
+  Comp_sum* inout_sums = static_cast<Comp_sum*>(inout);
+
+  for (int idx = 0; idx < *len; ++idx) {
+    inout_sums[idx].merge(in_sums[idx]);
+  }
+}
+
+/*
+ * Number of independent partial sums of the vectorized kernel, a multiple
+ * of the vector length of doubles up to AVX-512, so that the additions
+ * to the different sums do not wait for each other.
+ */
+static const unsigned Lanes = 8;
 
-static const unsigned Msg_tag = 5U;
+/*
+ * Sum of the function values in the bins [bin_begin; bin_end) by the midpoint rule.
+ * Midpoint of the bin is computed from its index rather than accumulated,
+ * so that the rounding errors do not pile up and the iterations are independent.
+ * Each lane keeps its own sum in double with the Kahan compensation,
+ * lanes are added in long double at the end.
+ */
+static Comp_sum simd_sum(unsigned long long bin_begin, unsigned long long bin_end,
+                         long double step) {
 
-static const unsigned long long Nbin = 10000000000U;
-static const long double Step = 1. / Nbin;
+  alignas(64) double lane_sum[Lanes] = {};
+  alignas(64) double lane_comp[Lanes] = {};
 
-long double mpi_get_pi_estimation(int size) {
+  double lane_step = static_cast<double>(step);
+  unsigned long long simd_end = bin_end - (bin_end - bin_begin) % Lanes;
 
-  long double sum = 0;
+  for (unsigned long long bin_idx = bin_begin; bin_idx < simd_end; bin_idx += Lanes) {
 
-  for (unsigned proc_idx = 0; proc_idx < (unsigned)size-1; ++proc_idx) {
+    /* Bin indices up to 2^52 are exact in double */
+    double first = static_cast<double>(bin_idx) + 0.5;
 
-    long double payload;
-    int res = MPI_Recv(&payload, 1, MPI_LONG_DOUBLE, MPI_ANY_SOURCE, Msg_tag, 
-                                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    EXIT_ON_MPI_FAILURE(res);
+    #pragma omp simd aligned(lane_sum, lane_comp : 64)
+    for (unsigned lane = 0; lane < Lanes; ++lane) {
 
-    sum += payload;
+      double x = (first + lane) * lane_step;
+      double value = 4. / (1. + x*x);
+
+      double term = value - lane_comp[lane];
+      double sum = lane_sum[lane] + term;
+
+      lane_comp[lane] = (sum - lane_sum[lane]) - term;
+      lane_sum[lane] = sum;
+    }
+  }
+
+  Comp_sum acc{0, 0};
+
+  for (unsigned lane = 0; lane < Lanes; ++lane) {
+    acc.merge(Comp_sum{lane_sum[lane], -static_cast<long double>(lane_comp[lane])});
   }
 
-  return sum / Nbin;
+  for (unsigned long long bin_idx = simd_end; bin_idx < bin_end; ++bin_idx) {
+
+    double x = (static_cast<double>(bin_idx) + 0.5) * lane_step;
+    acc.add(4. / (1. + x*x));
+  }
+
+  return acc;
 }
 
-void main_process(int size) {
+/* Reference sum in long double for the verification of the vectorized kernel */
+static Comp_sum long_double_sum(unsigned long long bin_begin, unsigned long long bin_end,
+                                long double step) {
 
-  double start = MPI_Wtime();
-  std::cout << "Started at: " << start << std::endl;
+  Comp_sum acc{0, 0};
 
-  long double pi = mpi_get_pi_estimation(size);
-  auto prev_prec = std::cout.precision();
-  std::cout << "Pi est: " << std::setprecision(8) << pi 
-                          << std::setprecision(prev_prec) << std::endl;
+  for (unsigned long long bin_idx = bin_begin; bin_idx < bin_end; ++bin_idx) {
 
-  double finish = MPI_Wtime();
-  std::cout << "Finished at: " << finish << std::endl;
+    long double x = (bin_idx + 0.5L) * step;
+    acc.add(4.L / (1.L + x*x));
+  }
 
-  std::cout << "Elapsed: " << finish - start << std::endl;
+  return acc;
 }
 
-void secondary_process(int size, int rank) {
+using kernel = Comp_sum (*)(unsigned long long, unsigned long long, long double);
 
-  long double local_sum = 0;
-  unsigned long long bins_per_proc = Nbin / (size - 1);
+/*
+ * Sum over the bins [bin_begin; bin_end) of the process divided between
+ * the OpenMP threads. Partial sums of the threads are added in the order
+ * of the threads, so the result does not depend on the scheduling.
+ */
+static Comp_sum threaded_sum(kernel func, unsigned long long bin_begin,
+                             unsigned long long bin_end, long double step) {
 
-  long double x = ((rank - 1) * bins_per_proc - 0.5) * Step;
+  std::vector<Comp_sum> thread_sums(omp_get_max_threads(), Comp_sum{0, 0});
 
-  for (unsigned long long bin_idx = 0; bin_idx < bins_per_proc; ++bin_idx) {
+  #pragma omp parallel
+  {
+    unsigned long long count = bin_end - bin_begin;
+    int threads = omp_get_num_threads();
+    int thread = omp_get_thread_num();
 
-    x += Step;
-    local_sum += 4. / (1. + x*x);
+    thread_sums[thread] = func(bin_begin + DECOMP::block_begin(count, threads, thread),
+                               bin_begin + DECOMP::block_begin(count, threads, thread + 1), step);
   }
 
-  int res = MPI_Send(&local_sum, 1, MPI_LONG_DOUBLE, 0, Msg_tag, MPI_COMM_WORLD);
+  Comp_sum acc{0, 0};
+
+  for (const Comp_sum& thread_sum : thread_sums) {
+    acc.merge(thread_sum);
+  }
+
+  return acc;
+}
+
+/* Sum over the bins of all processes on the main process */
+static Comp_sum reduce_sum(kernel func, unsigned long long nbin, long double step,
+                           int rank, int size, MPI_Datatype comp_sum_type, MPI_Op comp_sum) {
+
+  /*
+   * Все процессы, включая главный, вычисляют свою часть суммы,
+   * остаток от деления числа отрезков достаётся первым процессам
+   */
+  Comp_sum local = threaded_sum(func, DECOMP::block_begin(nbin, size, rank),
+                                DECOMP::block_begin(nbin, size, rank + 1), step);
+
+  Comp_sum total{0, 0};
+  int res = MPI_Reduce(&local, &total, 1, comp_sum_type, comp_sum, 0, MPI_COMM_WORLD);
   EXIT_ON_MPI_FAILURE(res);
+
+  return total;
 }
 
 int main(int argc, char **argv)
 {
   int res, rank, size;
 
-  /* Инициализация среды MPI */
-  res = MPI_Init(&argc, &argv);
+  /*
+   * Инициализация среды MPI. Вызовы MPI выполняются только главным потоком
+   * вне параллельных областей, сумма процесса делится между потоками OpenMP.
+   */
+  int provided;
+  res = MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
   EXIT_ON_MPI_FAILURE(res);
 
   /* Общее число процессов в коммуникаторе */
   res = MPI_Comm_size(MPI_COMM_WORLD, &size);
   EXIT_ON_MPI_FAILURE(res);
-  
+
   /* Ранг процесса */
   res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   EXIT_ON_MPI_FAILURE(res);
-  
+
+  if (provided < MPI_THREAD_FUNNELED) {
+
+    if (rank == 0) {
+      std::cerr << "MPI implementation does not support MPI_THREAD_FUNNELED\n";
+    }
+
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  /*
+   * Необязательные аргументы: режим проверки, в котором сумма считается
+   * ещё раз в long double для сравнения, и число отрезков разбиения
+   */
+  unsigned long long nbin = Default_nbin;
+  bool verify = false;
+
+  try {
+
+    int arg_idx = 1;
+
+    if (arg_idx < argc && std::string(argv[arg_idx]) == "--verify") {
+      verify = true;
+      ++arg_idx;
+    }
+
+    if (arg_idx < argc) {
+      nbin = std::stoull(argv[arg_idx++]);
+    }
+
+    if (arg_idx < argc) {
+      throw std::invalid_argument("too many arguments");
+    }
+
+    if (nbin == 0) {
+      throw std::invalid_argument("number of bins must be positive");
+    }
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " [--verify] [<bins>]\n";
+    }
+
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  long double step = 1.L / nbin;
+
+  /* Сумма двух чисел long double с компенсацией как один элемент */
+  MPI_Datatype comp_sum_type;
+  res = MPI_Type_contiguous(2, MPI_LONG_DOUBLE, &comp_sum_type);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&comp_sum_type);
+  EXIT_ON_MPI_FAILURE(res);
+
+  MPI_Op comp_sum;
+  res = MPI_Op_create(comp_sum_op, 1, &comp_sum);
+  EXIT_ON_MPI_FAILURE(res);
+
+  double start = MPI_Wtime();
+
   if (rank == 0) {
-    main_process(size);
-  } else {
-    secondary_process(size, rank);
+    std::cout << "Started at: " << start << std::endl;
   }
 
+  Comp_sum total = reduce_sum(simd_sum, nbin, step, rank, size, comp_sum_type, comp_sum);
+  long double pi = total.value() * step;
+
+  if (rank == 0) {
+
+    auto prev_prec = std::cout.precision();
+    std::cout << "Pi est: " << std::setprecision(8) << pi
+                            << std::setprecision(prev_prec) << std::endl;
+
+    double finish = MPI_Wtime();
+    std::cout << "Finished at: " << finish << std::endl;
+
+    std::cout << "Elapsed: " << finish - start << std::endl;
+  }
+
+  if (verify) {
+
+    double ref_start = MPI_Wtime();
+
+    Comp_sum ref_total = reduce_sum(long_double_sum, nbin, step, rank, size,
+                                    comp_sum_type, comp_sum);
+    long double ref_pi = ref_total.value() * step;
+
+    if (rank == 0) {
+
+      /* Отличие от точного значения включает и погрешность метода средних прямоугольников */
+      const long double exact_pi = 3.141592653589793238462643383279502884L;
+
+      auto prev_prec = std::cout.precision();
+      std::cout << std::setprecision(20) << "Pi ref: " << ref_pi << "\n"
+                << "Ref elapsed: " << std::setprecision(prev_prec) << MPI_Wtime() - ref_start << "\n"
+                << std::scientific << std::setprecision(3)
+                << "Difference: " << std::abs(pi - ref_pi) << "\n"
+                << "Error est: " << std::abs(pi - exact_pi) << "\n"
+                << "Error ref: " << std::abs(ref_pi - exact_pi) << std::defaultfloat
+                << std::setprecision(prev_prec) << std::endl;
+    }
+  }
+
+  res = MPI_Op_free(&comp_sum);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_free(&comp_sum_type);
+  EXIT_ON_MPI_FAILURE(res);
+
   /* Остановка среды MPI */
   res = MPI_Finalize();
   EXIT_ON_MPI_FAILURE(res);
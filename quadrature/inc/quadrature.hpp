@@ -0,0 +1,76 @@
+#ifndef QUADRATURE_HPP
+#define QUADRATURE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "mpi.h"
+
+namespace QUAD {
+
+/* Type of integrated function */
+using function = std::function<double(double)>;
+
+/* 
+ * Integration strategy:
+ * - midpoint - uniform grid, midpoint rule, error O(h^2);
+ * - simpson  - uniform grid, Simpson's rule, error O(h^4);
+ * - adaptive - adaptive trapezoid rule (local stack algorithm), 
+ *              the periods are halved until the relative precision is reached.
+ */
+enum class strategy {
+
+  midpoint,
+  simpson,
+  adaptive
+};
+
+/*
+ * Execution backend:
+ * - sequential - calling thread only;
+ * - threads    - std::thread, uniform grids are split into equal blocks,
+ *                adaptive strategy runs on the global stack engine (GSTACK::Gstack_integrator);
+ * - mpi        - processes of the communicator, every process must call integrate(),
+ *                uniform grids are split into equal blocks, the bounds of the adaptive 
+ *                strategy are split into periods dealt out cyclically between the processes.
+ *                The result is returned on all processes.
+ */
+enum class backend {
+
+  sequential,
+  threads,
+  mpi
+};
+
+struct options {
+
+  strategy method = strategy::adaptive;
+  backend  exec   = backend::sequential;
+
+  /* Number of the grid intervals of the uniform strategies */
+  uint64_t intervals = 1 << 20;
+
+  /* Relative precision of the adaptive strategy */
+  double eps = 1E-6;
+
+  /* Number of threads of the 'threads' backend, 0 - hardware concurrency */
+  unsigned int threads = 0;
+
+  /* Communicator of the 'mpi' backend */
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  /* Periods per process the bounds are split into by the adaptive strategy of the 'mpi' backend */
+  unsigned int periods_per_proc = 16;
+};
+
+/* Integral of 'func' from 'a' to 'b', a < b */
+double integrate(const function& func, double a, double b, const options& opts = options{});
+
+/* Names of the strategies and backends for the reports and command line */
+std::string to_string(strategy method);
+std::string to_string(backend exec);
+
+}; // namespace QUAD
+
+#endif // QUADRATURE_HPP
@@ -0,0 +1,235 @@
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "quadrature.hpp"
+
+/*
+ * For each integrand and each pair of strategy and backend the benchmark
+ * finds the coarsest grid (or the largest precision of the adaptive strategy)
+ * giving the relative error below the target, measures the time of the integration
+ * with it and reports the fastest pair.
+ */
+
+struct Integrand {
+
+  std::string name;
+  QUAD::function func;
+  double a;
+  double b;
+  double exact;
+};
+
+/*
+ * Smooth, sharp peak and large derivative at the left bound. The adaptive strategy
+ * has relative precision on each period, so the bounds of the last one are not zero:
+ * periods next to the zero value of the function would be halved down to the underflow.
+ */
+static const std::vector<Integrand> Integrands = {
+  {"pi",   [](double x) { return 4. / (1. + x*x); }, 0., 1., M_PI},
+  {"peak", [](double x) { return 1. / ((x - 0.3) * (x - 0.3) + 1E-4); }, 0., 1.,
+           100. * (std::atan(70.) + std::atan(30.))},
+  {"sqrt", [](double x) { return std::sqrt(x); }, 1E-8, 1., 2. / 3. * (1. - 1E-12)}
+};
+
+/* Limits of the tuning: finest grid and smallest precision tried */
+static const uint64_t Max_intervals = 1ULL << 28;
+static const double Min_eps = 1E-15;
+
+/* Repetitions of the measurement of the tuned integration, minimum is reported */
+static const int Reps = 3;
+
+struct Measurement {
+
+  bool reached = false;
+  std::string parameter;
+  double error = 0;
+  double time  = 0;
+};
+
+static double relative_error(const Integrand& integrand, double value) {
+  return std::abs(value - integrand.exact) / std::abs(integrand.exact);
+}
+
+/*
+ * Sequential and threaded backends run on the main process only,
+ * MPI backend runs on all processes, which get the same results
+ */
+static Measurement measure(const Integrand& integrand, QUAD::options opts, double target) {
+
+  Measurement result;
+
+  auto run = [&]() { return QUAD::integrate(integrand.func, integrand.a, integrand.b, opts); };
+
+  /* Tuning: refine the grid or the precision until the target is reached */
+  while (true) {
+
+    result.error = relative_error(integrand, run());
+
+    if (result.error <= target) {
+      result.reached = true;
+      break;
+    }
+
+    if (opts.method == QUAD::strategy::adaptive) {
+
+      if (opts.eps / 10 < Min_eps) {
+        break;
+      }
+
+      opts.eps /= 10;
+
+    } else {
+
+      if (opts.intervals * 2 > Max_intervals) {
+        break;
+      }
+
+      opts.intervals *= 2;
+    }
+  }
+
+  std::ostringstream parameter;
+  if (opts.method == QUAD::strategy::adaptive) {
+    parameter << "eps=" << opts.eps;
+  } else {
+    parameter << "n=" << opts.intervals;
+  }
+  result.parameter = parameter.str();
+
+  result.time = std::numeric_limits<double>::max();
+
+  for (int rep = 0; rep < Reps; ++rep) {
+
+    if (opts.exec == QUAD::backend::mpi) {
+      int res = MPI_Barrier(opts.comm);
+      EXIT_ON_MPI_FAILURE(res);
+    }
+
+    double start = MPI_Wtime();
+    run();
+    result.time = std::min(result.time, MPI_Wtime() - start);
+  }
+
+  return result;
+}
+
+int main(int argc, char** argv) {
+
+  int res, rank, size;
+
+  res = MPI_Init(&argc, &argv);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Optional target relative error and number of threads of the threaded backend */
+  double target = 1E-10;
+  unsigned int threads = 0;
+
+  try {
+
+    if (argc > 1) {
+      target = std::stod(argv[1]);
+    }
+
+    if (argc > 2) {
+      threads = std::stoul(argv[2]);
+    }
+
+    if (!(target > 0)) {
+      throw std::invalid_argument("target error must be positive");
+    }
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " [<target error> [<threads>]]\n";
+    }
+
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<QUAD::strategy> strategies = {
+    QUAD::strategy::midpoint, QUAD::strategy::simpson, QUAD::strategy::adaptive
+  };
+
+  const std::vector<QUAD::backend> backends = {
+    QUAD::backend::sequential, QUAD::backend::threads, QUAD::backend::mpi
+  };
+
+  for (const Integrand& integrand : Integrands) {
+
+    if (rank == 0) {
+      std::cout << "Integrand: " << integrand.name << " on [" << integrand.a << ";"
+                << integrand.b << "], target error " << target << ", processes " << size << "\n";
+      std::cout << std::left << std::setw(10) << "strategy" << std::setw(12) << "backend"
+                << std::setw(16) << "parameter" << std::right << std::setw(12) << "error"
+                << std::setw(14) << "time" << "\n";
+    }
+
+    std::string fastest;
+    double fastest_time = std::numeric_limits<double>::max();
+
+    for (QUAD::strategy method : strategies) {
+      for (QUAD::backend exec : backends) {
+
+        if (exec != QUAD::backend::mpi && rank != 0) {
+          continue;
+        }
+
+        QUAD::options opts;
+        opts.method    = method;
+        opts.exec      = exec;
+        opts.intervals = 16;
+        opts.eps       = 1E-2;
+        opts.threads   = threads;
+
+        Measurement meas = measure(integrand, opts, target);
+
+        if (rank != 0) {
+          continue;
+        }
+
+        std::cout << std::left << std::setw(10) << QUAD::to_string(method)
+                  << std::setw(12) << QUAD::to_string(exec) << std::setw(16) << meas.parameter
+                  << std::right << std::scientific << std::setprecision(3)
+                  << std::setw(12) << meas.error << std::setw(14) << meas.time
+                  << std::defaultfloat << (meas.reached ? "" : "  target not reached") << std::endl;
+
+        if (meas.reached && meas.time < fastest_time) {
+          fastest = QUAD::to_string(method) + "/" + QUAD::to_string(exec) + " " + meas.parameter;
+          fastest_time = meas.time;
+        }
+      }
+    }
+
+    if (rank == 0) {
+
+      if (fastest.empty()) {
+        std::cout << "Fastest: target not reached\n\n";
+      } else {
+        std::cout << "Fastest: " << fastest << " (" << fastest_time << " sec)\n\n";
+      }
+    }
+  }
+
+  res = MPI_Finalize();
+  EXIT_ON_MPI_FAILURE(res);
+
+  return 0;
+}
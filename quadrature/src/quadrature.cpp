@@ -0,0 +1,241 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "quadrature.hpp"
+#include "global_stack.hpp"
+#include "decomposition.hpp"
+#include "comp_sum.hpp"
+
+namespace QUAD {
+
+namespace {
+
+/* Uniform grids have up to billions of points, sums are accumulated with the compensation */
+using Comp_sum = UTILS::comp_sum<double>;
+
+/*
+ * Weighted sum of the function values on the grid intervals [first; last):
+ * - midpoint - f(m_i);
+ * - simpson  - 2 f(x_i) + 4 f(m_i), the ends of the whole grid are corrected by uniform_finish().
+ * Points are computed from the interval index, so the blocks are independent.
+ */
+Comp_sum uniform_block(const function& func, double a, double h, strategy method,
+                       uint64_t first, uint64_t last) {
+
+  Comp_sum acc;
+
+  for (uint64_t idx = first; idx < last; ++idx) {
+
+    double mid = a + (idx + 0.5) * h;
+
+    if (method == strategy::midpoint) {
+      acc.add(func(mid));
+    } else {
+      acc.add(2 * func(a + idx * h) + 4 * func(mid));
+    }
+  }
+
+  return acc;
+}
+
+double uniform_finish(const function& func, double a, double b, double h, strategy method,
+                      Comp_sum total) {
+
+  if (method == strategy::midpoint) {
+    return total.value() * h;
+  }
+
+  /* Sum of 2 f(x_i) counts f(a) twice and misses f(b) */
+  total.add(func(b) - func(a));
+  return total.value() * h / 6;
+}
+
+/* Local stack algorithm of the global stack engine on the period [A;B], without the global stack */
+double adaptive_period(const function& func, double A, double B, double eps) {
+
+  Comp_sum acc;
+
+  GSTACK::integrate_local_stack(func, GSTACK::make_entry(func, A, B), eps,
+                                [&acc](double value) { acc.add(value); },
+                                [](GSTACK::Stack&) {});
+
+  return acc.value();
+}
+
+unsigned int threads_num(const options& opts) {
+
+  if (opts.threads != 0) {
+    return opts.threads;
+  }
+
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+double integrate_sequential(const function& func, double a, double b, const options& opts) {
+
+  if (opts.method == strategy::adaptive) {
+    return adaptive_period(func, a, b, opts.eps);
+  }
+
+  double h = (b - a) / opts.intervals;
+  return uniform_finish(func, a, b, h, opts.method,
+                        uniform_block(func, a, h, opts.method, 0, opts.intervals));
+}
+
+double integrate_threads(const function& func, double a, double b, const options& opts) {
+
+  unsigned int threads = threads_num(opts);
+
+  if (opts.method == strategy::adaptive) {
+
+    GSTACK::Gstack_integrator integrator{func, std::make_pair(a, b), threads};
+    integrator.set_eps(opts.eps);
+    integrator.integrate();
+
+    return integrator.res();
+  }
+
+  double h = (b - a) / opts.intervals;
+
+  std::vector<Comp_sum> thread_sums(threads);
+  std::vector<std::thread> tvec;
+
+  for (unsigned int thread_idx = 0; thread_idx < threads; ++thread_idx) {
+
+    tvec.push_back(std::thread([&, thread_idx]() {
+      thread_sums[thread_idx] =
+        uniform_block(func, a, h, opts.method,
+                      DECOMP::block_begin(opts.intervals, threads, thread_idx),
+                      DECOMP::block_begin(opts.intervals, threads, thread_idx + 1));
+    }));
+  }
+
+  for (auto& thread : tvec) {
+    thread.join();
+  }
+
+  /* Partial sums are added in the order of the threads, so the result is reproducible */
+  Comp_sum total;
+  for (const Comp_sum& thread_sum : thread_sums) {
+    total.merge(thread_sum);
+  }
+
+  return uniform_finish(func, a, b, h, opts.method, total);
+}
+
+/*
+ * Partial sums of all processes added in the order of the ranks,
+ * so that every process gets the same result
+ */
+Comp_sum allgather_sum(const Comp_sum& local, MPI_Comm comm, int size) {
+
+  std::vector<Comp_sum> proc_sums(size);
+
+  int res = MPI_Allgather(&local, 2, MPI_DOUBLE, proc_sums.data(), 2, MPI_DOUBLE, comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Comp_sum total;
+  for (const Comp_sum& proc_sum : proc_sums) {
+    total.merge(proc_sum);
+  }
+
+  return total;
+}
+
+double integrate_mpi(const function& func, double a, double b, const options& opts) {
+
+  int res, rank, size;
+
+  res = MPI_Comm_size(opts.comm, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(opts.comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (opts.method == strategy::adaptive) {
+
+    /*
+     * Cost of the periods differs a lot, so they are dealt out cyclically:
+     * each process gets periods from every part of the bounds
+     */
+    uint64_t periods = static_cast<uint64_t>(size) * std::max(1U, opts.periods_per_proc);
+    double width = (b - a) / periods;
+
+    Comp_sum local;
+
+    for (uint64_t period = rank; period < periods; period += size) {
+
+      double A = a + period * width;
+      double B = (period + 1 == periods) ? b : a + (period + 1) * width;
+
+      local.add(adaptive_period(func, A, B, opts.eps));
+    }
+
+    return allgather_sum(local, opts.comm, size).value();
+  }
+
+  double h = (b - a) / opts.intervals;
+
+  Comp_sum local = uniform_block(func, a, h, opts.method,
+                                 DECOMP::block_begin(opts.intervals, size, rank),
+                                 DECOMP::block_begin(opts.intervals, size, rank + 1));
+
+  return uniform_finish(func, a, b, h, opts.method, allgather_sum(local, opts.comm, size));
+}
+
+} // namespace
+
+double integrate(const function& func, double a, double b, const options& opts) {
+
+  if (!(a < b)) {
+    throw std::invalid_argument("left bound must be less than the right one");
+  }
+
+  if (opts.method != strategy::adaptive && opts.intervals == 0) {
+    throw std::invalid_argument("number of intervals must be positive");
+  }
+
+  if (opts.method == strategy::adaptive && !(opts.eps > 0)) {
+    throw std::invalid_argument("precision must be positive");
+  }
+
+  switch (opts.exec) {
+
+    case backend::sequential: return integrate_sequential(func, a, b, opts);
+    case backend::threads:    return integrate_threads(func, a, b, opts);
+    case backend::mpi:        return integrate_mpi(func, a, b, opts);
+  }
+
+  throw std::invalid_argument("unknown backend");
+}
+
+std::string to_string(strategy method) {
+
+  switch (method) {
+
+    case strategy::midpoint: return "midpoint";
+    case strategy::simpson:  return "simpson";
+    case strategy::adaptive: return "adaptive";
+  }
+
+  return "unknown";
+}
+
+std::string to_string(backend exec) {
+
+  switch (exec) {
+
+    case backend::sequential: return "sequential";
+    case backend::threads:    return "threads";
+    case backend::mpi:        return "mpi";
+  }
+
+  return "unknown";
+}
+
+}; // namespace QUAD
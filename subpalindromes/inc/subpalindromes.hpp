@@ -17,32 +17,43 @@ struct subpali_info_pos
 
 using subpali_info = std::vector<subpali_info_pos>;
 
+// Radii of the subpalindromes centered at 'idx' found by the direct expansion,
+// cost of the position grows with the radii
+template <typename CharT>
+subpali_info_pos find_subpalindromes_at(const std::basic_string<CharT>& source, std::size_t idx)
+{
+  auto len = source.size();
+  subpali_info_pos result{1U, 0U};
+
+  // Odd-length subpalindromes
+  while (idx >= result.odd && idx + result.odd < len
+         && source[idx - result.odd] == source[idx + result.odd])
+  {
+    ++result.odd;
+  }
+
+  // Even-length subpalindromes
+  while (idx >= result.even + 1U && idx + result.even < len
+         && source[idx - result.even - 1U] == source[idx + result.even])
+  {
+    ++result.even;
+  }
+
+  return result;
+}
+
 template <typename CharT>
 subpali_info find_subpalindromes_trivial(const std::basic_string<CharT>& source)
 {
   auto len = source.size();
   subpali_info results(len);
 
-#pragma omp parallel default(none) shared(results, len, source)
-  #pragma omp for
+#ifdef _OPENMP
+  #pragma omp parallel for default(none) shared(results, len, source)
+#endif
   for (std::size_t idx = 0U; idx != len; ++idx)
   {
-    results[idx].odd  = 1U;
-    results[idx].even = 0U;
-
-    // Odd-length subpalindromes
-    while (idx >= results[idx].odd && idx + results[idx].odd < len
-           && source[idx - results[idx].odd] == source[idx + results[idx].odd])
-    {
-      ++results[idx].odd;
-    }
-
-    // Even-length subpalindromes
-    while (idx >= results[idx].even + 1U && idx + results[idx].even < len
-           && source[idx - results[idx].even - 1U] == source[idx + results[idx].even])
-    {
-      ++results[idx].even;
-    }
+    results[idx] = find_subpalindromes_at(source, idx);
   }
 
   return results;
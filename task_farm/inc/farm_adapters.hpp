@@ -0,0 +1,38 @@
+#ifndef FARM_ADAPTERS_HPP
+#define FARM_ADAPTERS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "task_farm.hpp"
+#include "quadrature.hpp"
+#include "subpalindromes.hpp"
+
+namespace FARM {
+
+/*
+ * Adaptive quadrature on the task farm. The bounds [a, b] are split into 'periods'
+ * equal periods, a task is the integral of a period computed by QUAD::integrate
+ * with 'period_opts': the local stack algorithm of the 'sequential' backend or
+ * the global stack engine (GSTACK::Gstack_integrator) of the 'threads' backend.
+ * Cost of the periods differs by orders of magnitude near the peaks of the function.
+ * Collective over 'opts.comm', the integral is returned on all processes.
+ * Throws std::invalid_argument on a >= b, zero periods or the 'mpi' backend of the periods.
+ */
+double integrate(const QUAD::function& func, double a, double b, uint64_t periods,
+                 const QUAD::options& period_opts = QUAD::options{},
+                 const options& opts = options{}, stats* work = nullptr);
+
+/*
+ * Subpalindromes of 'source' on the task farm. A task is a position of the string,
+ * its radii are found by the direct expansion of the trivial algorithm, so the cost
+ * of a position grows with the radii: long palindromic regions are the expensive ones.
+ * Collective over 'opts.comm', 'source' is given on process 0 and the result is returned
+ * on process 0, empty on the others.
+ */
+ALGO::subpali_info find_subpalindromes(const std::string& source, const options& opts = options{},
+                                       stats* work = nullptr);
+
+} // namespace FARM
+
+#endif // FARM_ADAPTERS_HPP
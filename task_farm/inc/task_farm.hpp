@@ -0,0 +1,98 @@
+#ifndef TASK_FARM_HPP
+#define TASK_FARM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "task_queue.hpp"
+
+namespace FARM {
+
+/*
+ * How the tasks are assigned to the processes:
+ * - block - contiguous blocks of equal numbers of tasks, one per process,
+ *           the static split the MPI programs of the repository use;
+ * - farm  - process 0 keeps the queue of the tasks and hands them out in chunks
+ *           to the processes which have returned the results of their previous ones
+ *           (QUEUE::run of the common library). Process 0 only serves the queue,
+ *           unless it is the only one.
+ */
+enum class mode {
+
+  block,
+  farm
+};
+
+/* Throws std::invalid_argument on unknown name */
+mode mode_from_string(const std::string& name);
+
+std::string to_string(mode kind);
+
+struct options {
+
+  mode kind = mode::farm;
+
+  /* Tasks handed out per chunk */
+  uint64_t chunk = 1;
+
+  /*
+   * The first request of a worker asks for two chunks, the results of a chunk
+   * ask for one more, so that the next chunk is at hand while the reply travels
+   */
+  bool prefetch = true;
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+};
+
+/* Work of the calling process and the handler of a chunk, as of the queue of the farm */
+using stats = QUEUE::stats;
+using chunk_handler = QUEUE::chunk_handler;
+
+/*
+ * Collective over 'opts.comm'. Every task of [0, tasks) is computed by 'handler' on exactly
+ * one process, the results of 'result_size' bytes are placed to 'results' on process 0
+ * in the order of the tasks, 'results' is not accessed on the others.
+ * Returns the work of the calling process. Throws std::invalid_argument on zero chunk.
+ */
+stats run(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+          std::byte* results, const options& opts = options{});
+
+/*
+ * Typed front end of 'run': results of the tasks on process 0,
+ * empty vector on the others. The work of the calling process is stored to 'work'.
+ */
+template <typename R>
+std::vector<R> map(uint64_t tasks,
+                   const std::function<void(uint64_t first, uint64_t last, R* out)>& handler,
+                   const options& opts = options{}, stats* work = nullptr) {
+
+  static_assert(std::is_trivially_copyable_v<R>, "results are sent as bytes");
+  static_assert(alignof(R) <= alignof(std::max_align_t), "results are sent as bytes");
+
+  int rank;
+
+  int res = MPI_Comm_rank(opts.comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::vector<R> results(rank == 0 ? tasks : 0);
+
+  stats local = run(tasks, sizeof(R), [&handler](uint64_t first, uint64_t last, std::byte* out) {
+    handler(first, last, reinterpret_cast<R*>(out));
+  }, reinterpret_cast<std::byte*>(results.data()), opts);
+
+  if (work != nullptr) {
+    *work = local;
+  }
+
+  return results;
+}
+
+} // namespace FARM
+
+#endif // TASK_FARM_HPP
@@ -0,0 +1,82 @@
+#include <vector>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "comp_sum.hpp"
+#include "farm_adapters.hpp"
+
+namespace FARM {
+
+double integrate(const QUAD::function& func, double a, double b, uint64_t periods,
+                 const QUAD::options& period_opts, const options& opts, stats* work) {
+
+  if (!(a < b) || periods == 0) {
+    throw std::invalid_argument("invalid bounds or number of periods");
+  }
+
+  if (period_opts.exec == QUAD::backend::mpi) {
+    throw std::invalid_argument("periods are integrated by a single process");
+  }
+
+  double width = (b - a) / periods;
+
+  std::vector<double> period_sums = map<double>(periods,
+    [&](uint64_t first, uint64_t last, double* out) {
+
+      for (uint64_t period = first; period < last; ++period) {
+
+        double A = a + period * width;
+        double B = (period + 1 == periods) ? b : a + (period + 1) * width;
+
+        out[period - first] = QUAD::integrate(func, A, B, period_opts);
+      }
+    }, opts, work);
+
+  /*
+   * Sums of the periods are added in their order with the compensation term,
+   * so the result does not depend on the assignment of the periods
+   */
+  UTILS::comp_sum<double> total;
+
+  for (double value : period_sums) {
+    total.add(value);
+  }
+
+  double sum = total.value();
+
+  int res = MPI_Bcast(&sum, 1, MPI_DOUBLE, 0, opts.comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  return sum;
+}
+
+ALGO::subpali_info find_subpalindromes(const std::string& source, const options& opts,
+                                       stats* work) {
+
+  int rank;
+
+  int res = MPI_Comm_rank(opts.comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Expansion of any position may read any part of the string, every process gets all of it */
+  uint64_t length = source.size();
+
+  res = MPI_Bcast(&length, 1, MPI_UINT64_T, 0, opts.comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::string text = (rank == 0)? source : std::string(length, '\0');
+
+  res = MPI_Bcast(text.data(), static_cast<int>(length), MPI_CHAR, 0, opts.comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  return map<ALGO::subpali_info_pos>(length,
+    [&text](uint64_t first, uint64_t last, ALGO::subpali_info_pos* out) {
+
+      for (uint64_t idx = first; idx < last; ++idx) {
+        out[idx - first] = ALGO::find_subpalindromes_at(text, idx);
+      }
+    }, opts, work);
+}
+
+} // namespace FARM
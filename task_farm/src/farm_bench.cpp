@@ -0,0 +1,278 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "task_farm.hpp"
+#include "farm_adapters.hpp"
+
+/*
+ * Compares the static split with the task farm on the tasks of irregular cost:
+ * - peak        - adaptive quadrature of the sharp peak, periods next to it take
+ *                 the most of the halvings;
+ * - palindromes - subpalindromes of a random string with a long run of one letter,
+ *                 the expansion of the positions of the run is quadratic in its length.
+ * For each workload and schedule the benchmark reports the time of the slowest process
+ * (minimum over the repetitions), the load imbalance: the largest compute time of a process
+ * over the mean one (the master of the farm only serves the queue and is not counted),
+ * the largest time a worker has waited for the chunks, and the check of the result.
+ */
+
+struct Bench_options {
+
+  uint64_t periods      = 1024;
+  uint64_t period_chunk = 4;
+  double   eps          = 1E-10;
+
+  /* Threads integrating a period, more than one - global stack engine */
+  unsigned threads = 1;
+
+  uint64_t length         = 1 << 20;
+  uint64_t run            = 1 << 14;
+  uint64_t position_chunk = 4096;
+};
+
+struct Schedule {
+
+  std::string name;
+  FARM::mode kind;
+  bool prefetch;
+};
+
+static const std::vector<Schedule> Schedules = {
+  {"block",    FARM::mode::block, false},
+  {"farm",     FARM::mode::farm,  false},
+  {"prefetch", FARM::mode::farm,  true}
+};
+
+/* Repetitions of the measurement, minimum is reported */
+static const int Reps = 3;
+
+static const double Peak_exact = 100. * (std::atan(70.) + std::atan(30.));
+
+static double peak(double x) {
+  return 1. / ((x - 0.3) * (x - 0.3) + 1E-4);
+}
+
+static const char* options_usage() {
+  return "[--periods <N>] [--period-chunk <N>] [--eps <eps>] [--threads <N>] "
+         "[--length <N>] [--run <N>] [--position-chunk <N>]";
+}
+
+/* Throws std::invalid_argument on unknown or malformed option */
+static Bench_options parse_options(int argc, char** argv) {
+
+  Bench_options options;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[arg_idx + 1];
+
+    if (name == "--periods") {
+      options.periods = std::stoull(value);
+    } else if (name == "--period-chunk") {
+      options.period_chunk = std::stoull(value);
+    } else if (name == "--eps") {
+      options.eps = std::stod(value);
+    } else if (name == "--threads") {
+      options.threads = std::stoul(value);
+    } else if (name == "--length") {
+      options.length = std::stoull(value);
+    } else if (name == "--run") {
+      options.run = std::stoull(value);
+    } else if (name == "--position-chunk") {
+      options.position_chunk = std::stoull(value);
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.periods == 0 || options.period_chunk == 0 || !(options.eps > 0) ||
+      options.threads == 0 || options.position_chunk == 0) {
+    throw std::invalid_argument("periods, chunks, precision and threads must be positive");
+  }
+
+  if (options.run > options.length) {
+    throw std::invalid_argument("run is longer than the string");
+  }
+
+  return options;
+}
+
+/* Random letters 'a' and 'b' with the run of 'a' in the last quarter, on process 0 only */
+static std::string make_text(const Bench_options& options) {
+
+  std::string text(options.length, 'a');
+
+  std::mt19937 gen(2024);
+  std::bernoulli_distribution letter;
+
+  for (char& chr : text) {
+    chr = letter(gen) ? 'b' : 'a';
+  }
+
+  uint64_t run_begin = options.length / 4 * 3 - std::min(options.length / 4 * 3, options.run / 2);
+  std::fill_n(text.begin() + run_begin, options.run, 'a');
+
+  return text;
+}
+
+struct Measurement {
+
+  double time      = std::numeric_limits<double>::max();
+  double imbalance = 0;
+  double wait      = 0;
+  bool   correct   = true;
+};
+
+/* Reduce the work of the processes of the last repetition to the report of process 0 */
+static void summarize(Measurement& meas, double elapsed, const FARM::stats& work,
+                      FARM::mode kind, int size, int rank) {
+
+  double slowest;
+  int res = MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::vector<double> computes(rank == 0 ? size : 0);
+  res = MPI_Gather(&work.compute, 1, MPI_DOUBLE, computes.data(), 1, MPI_DOUBLE, 0,
+                   MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  double max_wait;
+  res = MPI_Reduce(&work.wait, &max_wait, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank != 0) {
+    return;
+  }
+
+  /* Master of the farm only serves the queue */
+  if (kind == FARM::mode::farm && size > 1) {
+    computes.erase(computes.begin());
+  }
+
+  double mean = 0;
+  for (double compute : computes) {
+    mean += compute / computes.size();
+  }
+
+  meas.time      = std::min(meas.time, slowest);
+  meas.imbalance = (mean > 0)? *std::max_element(computes.begin(), computes.end()) / mean : 1.;
+  meas.wait      = max_wait;
+}
+
+int main(int argc, char** argv) {
+
+  MPI::MPI_env mpi_env(argc, argv);
+
+  int size, rank;
+
+  int res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Bench_options options;
+
+  try {
+
+    options = parse_options(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    }
+
+    return EXIT_FAILURE;
+  }
+
+  QUAD::options period_opts;
+  period_opts.eps     = options.eps;
+  period_opts.exec    = (options.threads > 1)? QUAD::backend::threads : QUAD::backend::sequential;
+  period_opts.threads = options.threads;
+
+  std::string text;
+  ALGO::subpali_info expected;
+
+  if (rank == 0) {
+    text     = make_text(options);
+    expected = ALGO::find_subpalindromes_manaker(text);
+
+    std::cout << "Processes: " << size << ", periods: " << options.periods << " by "
+              << options.period_chunk << ", eps: " << options.eps << ", threads: "
+              << options.threads << "\nString: " << options.length << " letters, run of "
+              << options.run << ", positions by " << options.position_chunk << "\n";
+    std::cout << std::left << std::setw(13) << "workload" << std::setw(10) << "schedule"
+              << std::right << std::setw(10) << "time, s" << std::setw(11) << "imbalance"
+              << std::setw(10) << "wait, s" << std::setw(7) << "check" << "\n";
+  }
+
+  for (const char* workload : {"peak", "palindromes"}) {
+    for (const Schedule& schedule : Schedules) {
+
+      bool is_peak = (std::string(workload) == "peak");
+
+      FARM::options opts;
+      opts.kind     = schedule.kind;
+      opts.prefetch = schedule.prefetch;
+      opts.chunk    = is_peak ? options.period_chunk : options.position_chunk;
+
+      Measurement meas;
+
+      for (int rep = 0; rep < Reps; ++rep) {
+
+        FARM::stats work;
+
+        res = MPI_Barrier(MPI_COMM_WORLD);
+        EXIT_ON_MPI_FAILURE(res);
+
+        double start = MPI_Wtime();
+
+        if (is_peak) {
+
+          double value = FARM::integrate(peak, 0., 1., options.periods, period_opts, opts, &work);
+          meas.correct = meas.correct && std::abs(value - Peak_exact) / Peak_exact < 1E-8;
+
+        } else {
+
+          ALGO::subpali_info found = FARM::find_subpalindromes(text, opts, &work);
+
+          meas.correct = meas.correct && (rank != 0 ||
+            std::equal(found.begin(), found.end(), expected.begin(), expected.end(),
+                       [](const ALGO::subpali_info_pos& lhs, const ALGO::subpali_info_pos& rhs) {
+                         return lhs.odd == rhs.odd && lhs.even == rhs.even;
+                       }));
+        }
+
+        summarize(meas, MPI_Wtime() - start, work, schedule.kind, size, rank);
+      }
+
+      if (rank == 0) {
+        std::cout << std::left << std::setw(13) << workload << std::setw(10) << schedule.name
+                  << std::right << std::fixed << std::setprecision(4) << std::setw(10)
+                  << meas.time << std::setprecision(3) << std::setw(11) << meas.imbalance
+                  << std::setprecision(4) << std::setw(10) << meas.wait << std::setw(7)
+                  << (meas.correct ? "ok" : "FAIL") << std::defaultfloat << std::endl;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "task_farm.hpp"
+#include "decomposition.hpp"
+#include "task_queue.hpp"
+
+namespace FARM {
+
+namespace {
+
+stats run_block(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+                std::byte* results, MPI_Comm comm, int size, int rank) {
+
+  uint64_t first = DECOMP::block_begin(tasks, size, rank);
+  uint64_t last  = DECOMP::block_begin(tasks, size, rank + 1);
+
+  std::vector<std::byte> local((last - first) * result_size);
+
+  stats work;
+
+  if (last > first) {
+
+    MPI::stopwatch sw;
+    sw.start();
+
+    handler(first, last, local.data());
+
+    work.compute = sw.stop();
+    work.tasks   = last - first;
+    work.chunks  = 1;
+  }
+
+  /* Counts of the gather are in results, so that large blocks fit int */
+  MPI_Datatype result_type;
+
+  int res = MPI_Type_contiguous(static_cast<int>(result_size), MPI_BYTE, &result_type);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&result_type);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::vector<int> counts(size);
+  std::vector<int> displs(size);
+
+  for (int proc = 0; proc < size; ++proc) {
+    displs[proc] = static_cast<int>(DECOMP::block_begin(tasks, size, proc));
+    counts[proc] = static_cast<int>(DECOMP::block_begin(tasks, size, proc + 1)) - displs[proc];
+  }
+
+  res = MPI_Gatherv(local.data(), counts[rank], result_type, results, counts.data(),
+                    displs.data(), result_type, 0, comm);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_free(&result_type);
+  EXIT_ON_MPI_FAILURE(res);
+
+  return work;
+}
+
+} // namespace
+
+mode mode_from_string(const std::string& name) {
+
+  if (name == "block") {
+    return mode::block;
+  } else if (name == "farm") {
+    return mode::farm;
+  }
+
+  throw std::invalid_argument("unknown mode " + name);
+}
+
+std::string to_string(mode kind) {
+  return (kind == mode::block)? "block" : "farm";
+}
+
+stats run(uint64_t tasks, std::size_t result_size, const chunk_handler& handler,
+          std::byte* results, const options& opts) {
+
+  if (opts.chunk == 0) {
+    throw std::invalid_argument("chunk must be positive");
+  }
+
+  int size, rank;
+
+  int res = MPI_Comm_size(opts.comm, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(opts.comm, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (opts.kind == mode::block) {
+    return run_block(tasks, result_size, handler, results, opts.comm, size, rank);
+  }
+
+  QUEUE::options queue_opts;
+  queue_opts.chunk    = opts.chunk;
+  queue_opts.prefetch = opts.prefetch;
+  queue_opts.comm     = opts.comm;
+
+  return QUEUE::run(tasks, result_size, handler, results, queue_opts);
+}
+
+} // namespace FARM
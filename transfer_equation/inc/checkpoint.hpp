@@ -0,0 +1,211 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace CHECKPOINT {
+
+/*
+ * Per-node checkpoints of the time layer.
+ *
+ * Each node writes the points [x_idx_begin; x_idx_end) it owns of the last
+ * complete layer into its own file. Files of two generations are kept
+ * and overwritten in turn, so that after an interrupted write the previous
+ * checkpoint is still intact. File is written under a temporary name and
+ * renamed when complete, a file with the final name is always complete.
+ */
+
+constexpr char Magic[8] = "PPCKPT";
+constexpr uint32_t Version = 1;
+
+/* Number of the kept generations of each node */
+constexpr unsigned Generations = 2;
+
+struct Header {
+
+  char magic[8];
+  uint32_t version;
+
+  /* Scheme and grid the checkpoint was made for */
+  uint32_t scheme;
+  uint64_t x_points;
+  uint64_t t_points;
+  double tau;
+
+  /* Decomposition */
+  int32_t size;
+  int32_t rank;
+  uint64_t x_idx_begin;
+  uint64_t x_idx_end;
+
+  /* Time layer stored in the file */
+  uint64_t step;
+};
+
+/* Header of the checkpoints of the node, step is set by the writer */
+inline Header make_header(uint32_t scheme, uint64_t x_points, uint64_t t_points, double tau,
+                          int size, int rank, uint64_t x_idx_begin, uint64_t x_idx_end) {
+
+  Header header{};
+  std::memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.scheme = scheme;
+  header.x_points = x_points;
+  header.t_points = t_points;
+  header.tau = tau;
+  header.size = size;
+  header.rank = rank;
+  header.x_idx_begin = x_idx_begin;
+  header.x_idx_end = x_idx_end;
+  return header;
+}
+
+/* Checkpoint was made for the same grid, scheme and node, the chunk of the node may differ */
+inline bool is_same_run(const Header& lhs, const Header& rhs) {
+
+  return std::memcmp(lhs.magic, rhs.magic, sizeof(Magic)) == 0 && lhs.version == rhs.version
+      && lhs.scheme == rhs.scheme && lhs.x_points == rhs.x_points && lhs.t_points == rhs.t_points
+      && lhs.tau == rhs.tau && lhs.size == rhs.size && lhs.rank == rhs.rank;
+}
+
+/* Checkpoint was made by the same run configuration, except for the step */
+inline bool is_compatible(const Header& lhs, const Header& rhs) {
+
+  return is_same_run(lhs, rhs) 
+      && lhs.x_idx_begin == rhs.x_idx_begin && lhs.x_idx_end == rhs.x_idx_end;
+}
+
+inline std::string file_name(const std::string& prefix, int rank, unsigned generation) {
+
+  return prefix + "." + std::to_string(rank) + "." + std::to_string(generation);
+}
+
+/*
+ * Read the header of the checkpoint of the given generation. Returns false if the file
+ * is missing or made for a different run than 'expected', the chunk is not compared.
+ */
+inline bool read_header(const std::string& prefix, unsigned generation, const Header& expected,
+                        Header& header) {
+
+  std::ifstream input(file_name(prefix, expected.rank, generation), std::ios::binary);
+
+  return input.read(reinterpret_cast<char*>(&header), sizeof(header)) 
+      && is_same_run(header, expected);
+}
+
+/*
+ * Read the checkpoint of the given generation. Returns false if the file
+ * is missing, broken or made for a different configuration than 'expected'.
+ */
+inline bool read(const std::string& prefix, unsigned generation, const Header& expected,
+                 Header& header, std::vector<double>& values) {
+
+  std::ifstream input(file_name(prefix, expected.rank, generation), std::ios::binary);
+
+  if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      !is_compatible(header, expected)) {
+    return false;
+  }
+
+  values.resize(header.x_idx_end - header.x_idx_begin);
+
+  return static_cast<bool>(input.read(reinterpret_cast<char*>(values.data()),
+                                      values.size() * sizeof(double)));
+}
+
+/*
+ * Writes checkpoints in the background. The layer is copied into the buffer
+ * and written by a separate thread while the node goes on computing,
+ * the next checkpoint waits for the previous one to be complete.
+ */
+class Writer {
+
+  std::string prefix_m;
+  Header header_m;
+
+  unsigned generation_m = 0;
+  unsigned written_m = 0;
+
+  std::vector<double> buffer;
+  std::future<void> pending;
+
+public:
+
+  Writer(const std::string& prefix, const Header& header)
+  : prefix_m(prefix),
+    header_m(header),
+    buffer(header.x_idx_end - header.x_idx_begin)
+    {}
+
+  Writer(const Writer& that) = delete;
+  Writer& operator=(const Writer& that) = delete;
+
+  ~Writer() {
+
+    if (pending.valid()) {
+      pending.wait();
+    }
+  }
+
+  /* Number of the started checkpoints */
+  unsigned written() const noexcept { return written_m; }
+
+  /*
+   * Start writing layer 'step' of the owned points, 'get(m, k)' gives the point value.
+   * Throws std::runtime_error if the previous checkpoint failed.
+   */
+  template <typename Getter>
+  void start(uint64_t step, Getter get) {
+
+    wait();
+
+    for (uint64_t m = header_m.x_idx_begin; m < header_m.x_idx_end; ++m) {
+      buffer[m - header_m.x_idx_begin] = get(m, step);
+    }
+
+    header_m.step = step;
+
+    std::string path = file_name(prefix_m, header_m.rank, generation_m);
+    generation_m = (generation_m + 1) % Generations;
+    ++written_m;
+
+    pending = std::async(std::launch::async, [this, path, header = header_m]() {
+
+      std::string tmp_path = path + ".tmp";
+
+      {
+        std::ofstream output(tmp_path, std::ios::binary | std::ios::trunc);
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(double));
+
+        if (!output.flush()) {
+          throw std::runtime_error("cannot write checkpoint " + tmp_path);
+        }
+      }
+
+      if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("cannot rename checkpoint " + tmp_path);
+      }
+    });
+  }
+
+  /* Wait for the checkpoint being written, rethrows its error */
+  void wait() {
+
+    if (pending.valid()) {
+      pending.get();
+    }
+  }
+};
+
+} // namespace CHECKPOINT
+
+#endif // CHECKPOINT_HPP
@@ -2,14 +2,94 @@
 #define COMP_MATH_HPP
 
 #include <stdint.h>
+#include <cmath>
+#include <vector>
+#include <string>
 #include <functional>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
 
-class Comp_scheme {
+#include "tridiag.hpp"
+
+/* Difference schemes for the transfer equation, c = a * tau / h is the Courant number */
+enum class Scheme {
+
+  /* u[m][k+1] = (u[m+1] + u[m-1]) / 2 - c * (u[m+1] - u[m-1]) / 2 + tau * f */
+  lax_friedrichs,
+
+  /* Second order: Lax-Friedrichs plus c^2 * (u[m+1] - 2 * u[m] + u[m-1]) / 2 correction */
+  lax_wendroff,
+
+  /* Explicit corner scheme, one-sided difference against the flow */
+  upwind,
+
+  /* 
+   * Implicit central scheme, unconditionally stable:
+   * -c/2 * u[m-1][k+1] + u[m][k+1] + c/2 * u[m+1][k+1] = u[m][k] + tau * f
+   */
+  implicit
+};
+
+/* Scheme by name: "lf", "lw", "upwind", "implicit" */
+inline Scheme scheme_from_string(const std::string& name) {
+
+  if (name == "lf")       return Scheme::lax_friedrichs;
+  if (name == "lw")       return Scheme::lax_wendroff;
+  if (name == "upwind")   return Scheme::upwind;
+  if (name == "implicit") return Scheme::implicit;
+
+  throw std::invalid_argument("unknown scheme " + name);
+}
+
+/* 
+ * Explicit schemes in one dimension: new value of the point 
+ * from the values of the previous layer in the point and its neighbours,
+ * c is the Courant number. Right-hand side is added by the caller.
+ */
+template <Scheme S>
+inline double explicit_step(double left, double mid, double right, double c) {
+
+  if constexpr (S == Scheme::lax_friedrichs) {
+    return (right + left) / 2 - c * (right - left) / 2;
+  }
+
+  if constexpr (S == Scheme::lax_wendroff) {
+    return mid - c * (right - left) / 2 + c * c * (right - 2 * mid + left) / 2;
+  }
+
+  if constexpr (S == Scheme::upwind) {
+    return (c >= 0)? mid - c * (mid - left) 
+                   : mid - c * (right - mid);
+  }
+
+  return 0;
+}
+
+/* 
+ * Right-hand side of the homogeneous equation, f = 0.
+ * Schemes skip evaluation of the right-hand side for it entirely.
+ */
+struct Homogeneous {
+
+  template <typename... Args>
+  constexpr double operator()(Args...) const noexcept { return 0; }
+};
+
+/* 
+ * Difference scheme for the right-hand side f(m, k) of type Rside. 
+ * Any callable is accepted, so that it is inlined into the kernels
+ * instead of the indirect call per grid point.
+ */
+template <typename Rside = Homogeneous>
+class Basic_comp_scheme {
 
 public:
 
-  using rside_func_type = std::function<double(uint64_t, uint64_t)>;
-  using bound_func_type = std::function<double(double)>;
+  using rside_func_type = Rside;
+
+  /* Right-hand side is zero and is not evaluated */
+  static constexpr bool homogeneous = std::is_same_v<Rside, Homogeneous>;
 
 private:
 
@@ -20,39 +100,51 @@ private:
   uint64_t t_points_m;
 
   double a_m;
+  Scheme scheme_m;
   rside_func_type f_m;
 
   double** u = nullptr;
   double* data = nullptr;
 
+  /* Implicit scheme: local part of the system and its solution */
+  TRIDIAG::Partition partition;
+  std::vector<TRIDIAG::Row> rows;
+  std::vector<double> solution;
+
 public:
 
-  Comp_scheme(double h, double tau, 
-              uint64_t x_points, uint64_t t_points, double a, 
-              rside_func_type f = [](uint64_t m, uint64_t k){ (void)m; (void)k; return 0; })
+  Basic_comp_scheme(double h, double tau, 
+                    uint64_t x_points, uint64_t t_points, double a, 
+                    Scheme scheme = Scheme::lax_friedrichs,
+                    Rside f = Homogeneous{})
   : h_m(h), 
     tau_m(tau), 
     x_points_m(x_points), 
     t_points_m(t_points), 
     a_m(a), 
+    scheme_m(scheme),
     f_m(f)
     {}
 
-  Comp_scheme(const Comp_scheme& that) = delete;
-  Comp_scheme& operator=(const Comp_scheme& that) = delete;
+  Basic_comp_scheme(const Basic_comp_scheme& that) = delete;
+  Basic_comp_scheme& operator=(const Basic_comp_scheme& that) = delete;
 
-  Comp_scheme(Comp_scheme&& that)
+  Basic_comp_scheme(Basic_comp_scheme&& that)
   : h_m(that.h_m), 
     tau_m(that.tau_m), 
     x_points_m(that.x_points_m), 
     t_points_m(that.t_points_m), 
     a_m(that.a_m), 
+    scheme_m(that.scheme_m),
     f_m(that.f_m),
     u(std::exchange(that.u, nullptr)),
-    data(std::exchange(that.data, nullptr))
+    data(std::exchange(that.data, nullptr)),
+    partition(std::move(that.partition)),
+    rows(std::move(that.rows)),
+    solution(std::move(that.solution))
     {}
 
-  Comp_scheme& operator=(Comp_scheme&& that) {
+  Basic_comp_scheme& operator=(Basic_comp_scheme&& that) {
     
     swap(that);
     return *this;
@@ -65,6 +157,18 @@ public:
   uint64_t t_points() const noexcept { return t_points_m; }
 
   double a() const noexcept { return a_m; }
+  Scheme scheme() const noexcept { return scheme_m; }
+
+  /* Courant number */
+  double courant() const noexcept { return a_m * tau_m / h_m; }
+
+  /* 
+   * Explicit schemes are stable only for |c| <= 1,
+   * the implicit one is stable for any time step 
+   */
+  bool is_stable() const noexcept { 
+    return scheme_m == Scheme::implicit || std::abs(courant()) <= 1.; 
+  }
   rside_func_type f() const 
   noexcept(std::is_nothrow_copy_constructible<rside_func_type>::value) { 
     return f_m; 
@@ -86,46 +190,105 @@ public:
     delete[] u;
   }
 
-  void set_boundary_time(uint64_t m, bound_func_type psi) {
+  /* u(t, m) = psi(t), any callable double(double) */
+  template <typename Bound>
+  void set_boundary_time(uint64_t m, Bound psi) {
 
     for (uint64_t t_idx = 0; t_idx < t_points_m; ++t_idx) {
       set(m, t_idx, psi(t_idx * tau_m));
     }
   }
 
-  void set_boundary_coord(uint64_t m_begin, uint64_t m_end, bound_func_type fi) {
+  /* u(0, x) = fi(x) for the points [m_begin; m_end), any callable double(double) */
+  template <typename Bound>
+  void set_boundary_coord(uint64_t m_begin, uint64_t m_end, Bound fi) {
 
+    /* Same schedule as in computations, so that pages are first touched by their threads */
+  #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+  #endif
     for (uint64_t x_idx = m_begin; x_idx < m_end; ++x_idx) {
       set(x_idx, 0, fi(x_idx * h_m));
     }
   }
 
+  /* Compute single point of the layer k+1, explicit schemes only */
   void compute(uint64_t m, uint64_t k) {
     
-    auto diff = u[m+1][k] - u[m-1][k];
-    u[m][k+1] = tau_m * (f_m(m, k) - a_m * diff / (2 * h_m)) + diff / 2;
+    compute_range(m, m+1, k);
   }
 
+  /* Compute points [m_begin; m_end) of the layer k+1, explicit schemes only */
   void compute_range(uint64_t m_begin, uint64_t m_end, uint64_t k) {
 
+    switch (scheme_m) {
+
+      case Scheme::lax_friedrichs:
+        compute_range_explicit<Scheme::lax_friedrichs>(m_begin, m_end, k);
+        break;
+
+      case Scheme::lax_wendroff:
+        compute_range_explicit<Scheme::lax_wendroff>(m_begin, m_end, k);
+        break;
+
+      case Scheme::upwind:
+        compute_range_explicit<Scheme::upwind>(m_begin, m_end, k);
+        break;
+
+      case Scheme::implicit:
+        throw std::logic_error("implicit scheme requires solving the system for the whole layer");
+    }
+  }
+
+  /* 
+   * Implicit scheme, first phase. Eliminate the unknowns of the layer k+1
+   * in [m_begin; m_end), m_end - m_begin >= 2, and return two rows of the reduced 
+   * system in the unknowns u[m_begin][k+1], u[m_end-1][k+1] (see TRIDIAG::Partition).
+   * Boundary values of the layer k+1 must be set beforehand.
+   */
+  void implicit_reduce(uint64_t m_begin, uint64_t m_end, uint64_t k, TRIDIAG::Row reduced[2]) {
+
+    double half_c = courant() / 2;
+
+    rows.resize(m_end - m_begin);
+
     for (uint64_t m = m_begin; m < m_end; ++m) {
 
-    #ifdef DEBUG
-      std::cout << "computing u[" << m << "][" << k+1 << "]\n";
-      std::cout << "u[" << m+1 << "][" << k << "]=" << u[m+1][k] << " ";
-      std::cout << "u[" << m-1 << "][" << k << "]=" << u[m-1][k] << " ";
-    #endif
+      TRIDIAG::Row row{ -half_c, 1., half_c, u[m][k] + rside(m, k) };
 
-      auto diff = u[m+1][k] - u[m-1][k];
-      u[m][k+1] = tau_m * (f_m(m, k) - a_m * diff / (2 * h_m)) + diff / 2;
+      /* Known boundary values are moved to the right-hand side */
 
-    #ifdef DEBUG
-      std::cout << "u[" << m << "][" << k+1 << "]=" << u[m][k+1] << "\n";
-    #endif
+      if (m - 1 == 0) {
+        row.d += half_c * u[0][k+1];
+        row.a = 0;
+      }
+
+      if (m + 1 == x_points_m - 1) {
+        row.d -= half_c * u[m+1][k+1];
+        row.c = 0;
+      }
+
+      rows[m - m_begin] = row;
+    }
+
+    partition.reduce(rows.data(), rows.size(), reduced);
+  }
+
+  /* Implicit scheme, second phase: restore layer k+1 from the reduced system solution */
+  void implicit_expand(uint64_t m_begin, uint64_t m_end, uint64_t k, double first, double last) {
+
+    solution.resize(m_end - m_begin);
+    partition.expand(first, last, solution.data(), solution.size());
+
+    for (uint64_t m = m_begin; m < m_end; ++m) {
+      set(m, k+1, solution[m - m_begin]);
     }
   }
 
   double get(uint64_t m, uint64_t k) const noexcept { return u[m][k]; }
+
+  /* Pointer to the point, points of the same layer are strided by t_points */
+  double* point_ptr(uint64_t m, uint64_t k) noexcept { return &u[m][k]; }
   
   void set(uint64_t m, uint64_t k, double val) noexcept { 
 
@@ -136,18 +299,81 @@ public:
     u[m][k] = val; 
   }
 
-  void swap(Comp_scheme& that) {
+  void swap(Basic_comp_scheme& that) {
 
     std::swap(h_m, that.h_m); 
     std::swap(tau_m, that.tau_m); 
     std::swap(x_points_m, that.x_points_m); 
     std::swap(t_points_m, that.t_points_m); 
     std::swap(a_m, that.a_m); 
+    std::swap(scheme_m, that.scheme_m); 
     std::swap(f_m, that.f_m);
 
     std::swap(u, that.u);
     std::swap(data, that.data);
+
+    std::swap(partition, that.partition);
+    std::swap(rows, that.rows);
+    std::swap(solution, that.solution);
+  }
+
+private:
+
+  template <Scheme S>
+  double next(uint64_t m, uint64_t k) const {
+
+    double c = courant();
+
+    double left  = u[m-1][k];
+    double mid   = u[m][k];
+    double right = u[m+1][k];
+
+    if constexpr (homogeneous) {
+      return explicit_step<S>(left, mid, right, c);
+    } else {
+      return explicit_step<S>(left, mid, right, c) + rside(m, k);
+    }
+  }
+
+  /* Contribution of the right-hand side to the point of the layer k+1 */
+  double rside(uint64_t m, uint64_t k) const {
+
+    if constexpr (homogeneous) {
+      (void)m; (void)k;
+      return 0;
+    } else {
+      return tau_m * f_m(m, k);
+    }
+  }
+
+  template <Scheme S>
+  void compute_range_explicit(uint64_t m_begin, uint64_t m_end, uint64_t k) {
+
+    /* Hybrid build: the range is shared between threads of the node */
+  #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+  #endif
+    for (uint64_t m = m_begin; m < m_end; ++m) {
+
+    #ifdef DEBUG
+      std::cout << "computing u[" << m << "][" << k+1 << "]\n";
+      std::cout << "u[" << m+1 << "][" << k << "]=" << u[m+1][k] << " ";
+      std::cout << "u[" << m-1 << "][" << k << "]=" << u[m-1][k] << " ";
+    #endif
+
+      u[m][k+1] = next<S>(m, k);
+
+    #ifdef DEBUG
+      std::cout << "u[" << m << "][" << k+1 << "]=" << u[m][k+1] << "\n";
+    #endif
+    }
   }
 };
 
+/* Scheme of the homogeneous equation */
+using Comp_scheme = Basic_comp_scheme<Homogeneous>;
+
+/* Scheme with the right-hand side chosen at run time, pays an indirect call per point */
+using Comp_scheme_erased = Basic_comp_scheme<std::function<double(uint64_t, uint64_t)>>;
+
 #endif
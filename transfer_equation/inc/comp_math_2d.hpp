@@ -0,0 +1,323 @@
+#ifndef COMP_MATH_2D_HPP
+#define COMP_MATH_2D_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+#include "comp_math.hpp"
+
+/* Direction of the sweep: along the rows (x) or along the columns (y) */
+enum class Sweep { x, y };
+
+/* Rectangle of the local points [row_begin; row_end) x [col_begin; col_end) */
+struct Region {
+
+  uint64_t row_begin;
+  uint64_t row_end;
+
+  uint64_t col_begin;
+  uint64_t col_end;
+
+  bool empty() const noexcept { return row_begin >= row_end || col_begin >= col_end; }
+};
+
+/*
+ * Explicit schemes for the 2D advection equation u_t + ax * u_x + ay * u_y = f
+ * with the dimensional splitting: time step is made of the sweep along x
+ * followed by the sweep along y, each of them is the 1D scheme step.
+ *
+ * Scheme stores the block of the grid [row_begin; row_begin + rows) x
+ * [col_begin; col_begin + cols) surrounded by one point of halo on each side,
+ * x goes along the rows, y along the columns. Only two layers are kept:
+ * the current one and the intermediate one, made by the sweep along x.
+ * Values on the boundary of the whole grid are given by psi(t).
+ */
+template <typename Rside = Homogeneous>
+class Basic_comp_scheme_2d {
+
+public:
+
+  /* Right-hand side f(row, col, k), see Basic_comp_scheme */
+  using rside_func_type = Rside;
+
+  static constexpr bool homogeneous = std::is_same_v<Rside, Homogeneous>;
+
+  /* Tile of the kernels, sized to keep the rows of the tile in the cache */
+  static constexpr uint64_t Tile_rows = 16;
+  static constexpr uint64_t Tile_cols = 256;
+
+private:
+
+  double h_m;
+  double tau_m;
+
+  /* Grid points along x (columns), y (rows) and time */
+  uint64_t x_points_m;
+  uint64_t y_points_m;
+  uint64_t t_points_m;
+
+  double ax_m;
+  double ay_m;
+  Scheme scheme_m;
+  rside_func_type f_m;
+
+  /* Global position and size of the block */
+  uint64_t row_begin_m = 0;
+  uint64_t col_begin_m = 0;
+  uint64_t rows_m = 0;
+  uint64_t cols_m = 0;
+
+  /* Row of the block with the halo */
+  uint64_t stride_m = 0;
+
+  double* current_m = nullptr;
+  double* intermediate_m = nullptr;
+
+public:
+
+  Basic_comp_scheme_2d(double h, double tau,
+                       uint64_t x_points, uint64_t y_points, uint64_t t_points,
+                       double ax, double ay,
+                       Scheme scheme = Scheme::lax_friedrichs,
+                       Rside f = Homogeneous{})
+  : h_m(h),
+    tau_m(tau),
+    x_points_m(x_points),
+    y_points_m(y_points),
+    t_points_m(t_points),
+    ax_m(ax),
+    ay_m(ay),
+    scheme_m(scheme),
+    f_m(f)
+    {}
+
+  Basic_comp_scheme_2d(const Basic_comp_scheme_2d& that) = delete;
+  Basic_comp_scheme_2d& operator=(const Basic_comp_scheme_2d& that) = delete;
+
+  double h() const noexcept { return h_m; }
+  double tau() const noexcept { return tau_m; }
+
+  uint64_t x_points() const noexcept { return x_points_m; }
+  uint64_t y_points() const noexcept { return y_points_m; }
+  uint64_t t_points() const noexcept { return t_points_m; }
+
+  Scheme scheme() const noexcept { return scheme_m; }
+
+  /* Courant numbers along x and y */
+  double courant_x() const noexcept { return ax_m * tau_m / h_m; }
+  double courant_y() const noexcept { return ay_m * tau_m / h_m; }
+
+  /* Each sweep is stable for the Courant number |c| <= 1 */
+  bool is_stable() const noexcept {
+    return std::abs(courant_x()) <= 1. && std::abs(courant_y()) <= 1.;
+  }
+
+  uint64_t row_begin() const noexcept { return row_begin_m; }
+  uint64_t col_begin() const noexcept { return col_begin_m; }
+  uint64_t rows() const noexcept { return rows_m; }
+  uint64_t cols() const noexcept { return cols_m; }
+  uint64_t stride() const noexcept { return stride_m; }
+
+  /* Layers with the halo, point (i, j) of the block is at [(i + 1) * stride + j + 1] */
+  double* current() noexcept { return current_m; }
+  double* intermediate() noexcept { return intermediate_m; }
+
+  /* Allocate the block, implicit scheme is not supported */
+  void allocate(uint64_t row_begin, uint64_t rows, uint64_t col_begin, uint64_t cols) {
+
+    if (scheme_m == Scheme::implicit) {
+      throw std::logic_error("implicit scheme is not supported in 2D");
+    }
+
+    row_begin_m = row_begin;
+    col_begin_m = col_begin;
+    rows_m = rows;
+    cols_m = cols;
+    stride_m = cols + 2;
+
+    current_m = new double[(rows + 2) * stride_m];
+    intermediate_m = new double[(rows + 2) * stride_m];
+  }
+
+  void free() {
+
+    delete[] current_m;
+    delete[] intermediate_m;
+  }
+
+  /*
+   * Fill the current layer with u(0,x,y) = fi(x,y) and zero the rest.
+   * Rows are shared between threads, so that pages are first touched 
+   * by the threads of the node rather than by the main one.
+   */
+  template <typename Init>
+  void set_initial(Init fi) {
+
+    std::fill(current_m, current_m + stride_m, 0.);
+    std::fill(intermediate_m, intermediate_m + stride_m, 0.);
+
+  #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+  #endif
+    for (uint64_t i = 1; i <= rows_m; ++i) {
+
+      current_m[i * stride_m] = intermediate_m[i * stride_m] = 0.;
+      current_m[i * stride_m + cols_m + 1] = intermediate_m[i * stride_m + cols_m + 1] = 0.;
+
+      for (uint64_t j = 1; j <= cols_m; ++j) {
+
+        current_m[i * stride_m + j] = fi((col_begin_m + j - 1) * h_m, (row_begin_m + i - 1) * h_m);
+        intermediate_m[i * stride_m + j] = 0.;
+      }
+    }
+
+    std::fill(current_m + (rows_m + 1) * stride_m, current_m + (rows_m + 2) * stride_m, 0.);
+    std::fill(intermediate_m + (rows_m + 1) * stride_m, intermediate_m + (rows_m + 2) * stride_m, 0.);
+  }
+
+  /* Set u = psi(t) on the points of the block lying on the boundary of the grid */
+  template <typename Bound>
+  void set_boundary(double* layer, uint64_t k, Bound psi) {
+
+    double val = psi(k * tau_m);
+
+    for (uint64_t i = 1; i <= rows_m; ++i) {
+
+      uint64_t row = row_begin_m + i - 1;
+      bool boundary_row = (row == 0 || row == y_points_m - 1);
+
+      for (uint64_t j = 1; j <= cols_m; ++j) {
+
+        uint64_t col = col_begin_m + j - 1;
+
+        if (boundary_row || col == 0 || col == x_points_m - 1) {
+          layer[i * stride_m + j] = val;
+        }
+      }
+    }
+  }
+
+  /* Local points of the block to be computed, boundary of the grid is excluded */
+  Region compute_region() const noexcept {
+
+    Region region{ 1, rows_m + 1, 1, cols_m + 1 };
+
+    if (row_begin_m == 0)                    ++region.row_begin;
+    if (row_begin_m + rows_m == y_points_m)  --region.row_end;
+    if (col_begin_m == 0)                    ++region.col_begin;
+    if (col_begin_m + cols_m == x_points_m)  --region.col_end;
+
+    return region;
+  }
+
+  /*
+   * Sweep over the local region for the time step k -> k+1:
+   * along x from the current layer into the intermediate one,
+   * along y from the intermediate layer back into the current one.
+   */
+  template <Sweep D>
+  void sweep(const Region& region, uint64_t k) {
+
+    switch (scheme_m) {
+
+      case Scheme::lax_friedrichs:
+        sweep_tiled<D, Scheme::lax_friedrichs>(region, k);
+        break;
+
+      case Scheme::lax_wendroff:
+        sweep_tiled<D, Scheme::lax_wendroff>(region, k);
+        break;
+
+      case Scheme::upwind:
+        sweep_tiled<D, Scheme::upwind>(region, k);
+        break;
+
+      case Scheme::implicit:
+        throw std::logic_error("implicit scheme is not supported in 2D");
+    }
+  }
+
+  /* Point (i, j) of the current layer, local indices starting from 0 */
+  double get(uint64_t i, uint64_t j) const noexcept {
+    return current_m[(i + 1) * stride_m + j + 1];
+  }
+
+private:
+
+  template <Sweep D, Scheme S>
+  void sweep_tiled(const Region& region, uint64_t k) {
+
+    if (region.empty()) {
+      return;
+    }
+
+    uint64_t tile_rows = (region.row_end - region.row_begin + Tile_rows - 1) / Tile_rows;
+    uint64_t tile_cols = (region.col_end - region.col_begin + Tile_cols - 1) / Tile_cols;
+
+    /* Tiles are shared between threads of the node */
+  #ifdef _OPENMP
+    #pragma omp parallel for collapse(2) schedule(static)
+  #endif
+    for (uint64_t tile_i = 0; tile_i < tile_rows; ++tile_i) {
+      for (uint64_t tile_j = 0; tile_j < tile_cols; ++tile_j) {
+
+        uint64_t i_begin = region.row_begin + tile_i * Tile_rows;
+        uint64_t j_begin = region.col_begin + tile_j * Tile_cols;
+
+        uint64_t i_end = std::min(i_begin + Tile_rows, region.row_end);
+        uint64_t j_end = std::min(j_begin + Tile_cols, region.col_end);
+
+        for (uint64_t i = i_begin; i < i_end; ++i) {
+          sweep_row<D, S>(i, j_begin, j_end, k);
+        }
+      }
+    }
+  }
+
+  template <Sweep D, Scheme S>
+  void sweep_row(uint64_t i, uint64_t j_begin, uint64_t j_end, uint64_t k) {
+
+    if constexpr (D == Sweep::x) {
+
+      double c = courant_x();
+
+      const double* src = current_m + i * stride_m;
+      double* dst = intermediate_m + i * stride_m;
+
+      for (uint64_t j = j_begin; j < j_end; ++j) {
+        dst[j] = explicit_step<S>(src[j-1], src[j], src[j+1], c);
+      }
+
+    } else {
+
+      double c = courant_y();
+
+      const double* up   = intermediate_m + (i - 1) * stride_m;
+      const double* mid  = intermediate_m + i * stride_m;
+      const double* down = intermediate_m + (i + 1) * stride_m;
+      double* dst = current_m + i * stride_m;
+
+      uint64_t row = row_begin_m + i - 1;
+
+      for (uint64_t j = j_begin; j < j_end; ++j) {
+
+        if constexpr (homogeneous) {
+          dst[j] = explicit_step<S>(up[j], mid[j], down[j], c);
+        } else {
+          dst[j] = explicit_step<S>(up[j], mid[j], down[j], c)
+                 + tau_m * f_m(row, col_begin_m + j - 1, k);
+        }
+      }
+    }
+  }
+};
+
+/* Scheme of the homogeneous equation */
+using Comp_scheme_2d = Basic_comp_scheme_2d<Homogeneous>;
+
+#endif // COMP_MATH_2D_HPP
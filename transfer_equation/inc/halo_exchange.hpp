@@ -0,0 +1,52 @@
+#ifndef HALO_EXCHANGE_HPP
+#define HALO_EXCHANGE_HPP
+
+#include <array>
+#include <span>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+
+/*
+ * Exchange of the chunk border points with the neighbours of the one-dimensional
+ * decomposition. Each buffer holds 2*depth points:
+ * send_buf = { first depth points of the chunk, last depth points of the chunk },
+ * recv_buf = { depth points before the chunk, depth points after the chunk }.
+ * Points before the chunk belong to the right neighbour, after the chunk - to the left one,
+ * a missing neighbour is MPI_PROC_NULL.
+ */
+
+static const int Halo_tag = 5;
+
+/* Receives from the right and left neighbours followed by the sends to them */
+using Halo_requests = std::array<MPI::request, 4>;
+
+/* Post the non-blocking exchange, requests are created anew each call */
+inline Halo_requests start_halo_exchange(double* send_buf, double* recv_buf, int depth,
+                                         int lft_neigh, int rgt_neigh) {
+
+  return {
+    MPI::irecv(std::span(&recv_buf[0], depth), rgt_neigh, Halo_tag),
+    MPI::irecv(std::span(&recv_buf[depth], depth), lft_neigh, Halo_tag),
+    MPI::isend(std::span(&send_buf[0], depth), rgt_neigh, Halo_tag),
+    MPI::isend(std::span(&send_buf[depth], depth), lft_neigh, Halo_tag)
+  };
+}
+
+/*
+ * Bind the buffers and the neighbours to the persistent requests once,
+ * then each exchange is MPI::start_all followed by MPI::wait_all.
+ * Buffers must not be reallocated while the requests live.
+ */
+inline Halo_requests init_halo_exchange(double* send_buf, double* recv_buf, int depth,
+                                        int lft_neigh, int rgt_neigh) {
+
+  return {
+    MPI::recv_init(std::span(&recv_buf[0], depth), rgt_neigh, Halo_tag),
+    MPI::recv_init(std::span(&recv_buf[depth], depth), lft_neigh, Halo_tag),
+    MPI::send_init(std::span(&send_buf[0], depth), rgt_neigh, Halo_tag),
+    MPI::send_init(std::span(&send_buf[depth], depth), lft_neigh, Halo_tag)
+  };
+}
+
+#endif // HALO_EXCHANGE_HPP
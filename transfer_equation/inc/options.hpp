@@ -0,0 +1,178 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <stdexcept>
+
+#include "comp_math.hpp"
+
+/*
+ * How the halos and the last layer are exchanged between the nodes:
+ * - mpi - point-to-point messages and MPI_Gatherv;
+ * - shm - shared memory window of the processes, all of them have to be on one machine.
+ */
+enum class Transport {
+
+  mpi,
+  shm
+};
+
+inline Transport transport_from_string(const std::string& name) {
+
+  if (name == "mpi") return Transport::mpi;
+  if (name == "shm") return Transport::shm;
+
+  throw std::invalid_argument("unknown transport " + name);
+}
+
+/*
+ * Options accepted by a program:
+ * - sequential - grid, scheme and output of the single process solver;
+ * - parallel - also the decomposition, exchange and checkpoint options of the nodes.
+ */
+enum class Option_set {
+
+  sequential,
+  parallel
+};
+
+/* Run-time parameters of the solver */
+struct Solver_options {
+
+  /* Number of grid points by coordinate and by time */
+  uint64_t x_points = 10000008;
+  uint64_t t_points = 100;
+
+  /* Time step and difference scheme */
+  double tau = 5e-6;
+  Scheme scheme = Scheme::lax_friedrichs;
+
+  /*
+   * Width of the halo exchanged with neighbours.
+   * Equals to the number of time steps made between exchanges.
+   */
+  uint64_t halo_depth = 1;
+
+  /* Exchange of the halos and gathering of the last layer */
+  Transport transport = Transport::mpi;
+
+  /* Binary file for the last layer, not written if empty */
+  std::string output;
+
+  /* 
+   * File with the node weights for the decomposition. Weights are read 
+   * before the run and updated from the measured times after it.
+   * Points are split evenly if empty.
+   */
+  std::string balance;
+
+  /* 
+   * Prefix of the per-node checkpoint files, written every 
+   * 'checkpoint_interval' time steps. Checkpoints are disabled if empty.
+   */
+  std::string checkpoint;
+  uint64_t checkpoint_interval = 10;
+
+  /* Continue from the last checkpoint present on all nodes */
+  bool restart = false;
+};
+
+/* Usage string for the options below */
+inline const char* options_usage(Option_set set = Option_set::parallel) {
+
+  if (set == Option_set::sequential) {
+    return "[--x-points <N>] [--t-points <N>] [--tau <step>] [--scheme lf|lw|upwind|implicit] "
+           "[--output <file>]";
+  }
+
+  return "[--x-points <N>] [--t-points <N>] [--tau <step>] [--scheme lf|lw|upwind|implicit] "
+         "[--halo-depth <N>] [--transport mpi|shm] [--output <file>] [--balance <file>] "
+         "[--checkpoint <prefix>] [--checkpoint-interval <N>] [--restart]";
+}
+
+/*
+ * Parse command line options given as '--name value' pairs and '--restart' flag,
+ * options not given keep the values from 'defaults'.
+ * Throws std::invalid_argument on unknown or malformed option,
+ * or on an option outside of 'set'.
+ */
+inline Solver_options parse_options(int argc, char** argv, 
+                                    const Solver_options& defaults = Solver_options{},
+                                    Option_set set = Option_set::parallel) {
+
+  Solver_options options = defaults;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    bool common = name == "--x-points" || name == "--t-points" || name == "--tau" 
+               || name == "--scheme" || name == "--output";
+
+    if (set == Option_set::sequential && !common) {
+      throw std::invalid_argument("option " + name + " is not supported by the sequential solver");
+    }
+
+    /* Flags take no value */
+    if (name == "--restart") {
+      options.restart = true;
+      --arg_idx;
+      continue;
+    }
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[arg_idx + 1];
+
+    if (name == "--x-points") {
+      options.x_points = std::stoull(value);
+    } else if (name == "--t-points") {
+      options.t_points = std::stoull(value);
+    } else if (name == "--tau") {
+      options.tau = std::stod(value);
+    } else if (name == "--scheme") {
+      options.scheme = scheme_from_string(value);
+    } else if (name == "--halo-depth") {
+      options.halo_depth = std::stoull(value);
+    } else if (name == "--transport") {
+      options.transport = transport_from_string(value);
+    } else if (name == "--output") {
+      options.output = value;
+    } else if (name == "--balance") {
+      options.balance = value;
+    } else if (name == "--checkpoint") {
+      options.checkpoint = value;
+    } else if (name == "--checkpoint-interval") {
+      options.checkpoint_interval = std::stoull(value);
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.x_points < 3 || options.t_points < 2) {
+    throw std::invalid_argument("grid is too small");
+  }
+
+  if (!(options.tau > 0)) {
+    throw std::invalid_argument("time step must be positive");
+  }
+
+  if (options.halo_depth == 0) {
+    throw std::invalid_argument("halo depth must be positive");
+  }
+
+  if (options.checkpoint_interval == 0) {
+    throw std::invalid_argument("checkpoint interval must be positive");
+  }
+
+  if (options.restart && options.checkpoint.empty()) {
+    throw std::invalid_argument("restart requires checkpoint prefix");
+  }
+
+  return options;
+}
+
+#endif // OPTIONS_HPP
@@ -0,0 +1,83 @@
+#ifndef OPTIONS_2D_HPP
+#define OPTIONS_2D_HPP
+
+#include <stdint.h>
+#include <string>
+#include <stdexcept>
+
+#include "comp_math.hpp"
+
+/* Run-time parameters of the 2D solver */
+struct Solver_options_2d {
+
+  /* Number of grid points along x, y and by time */
+  uint64_t x_points = 4000;
+  uint64_t y_points = 4000;
+  uint64_t t_points = 100;
+
+  /* Time step and explicit difference scheme */
+  double tau = 5e-6;
+  Scheme scheme = Scheme::lax_friedrichs;
+
+  /* Binary file for the last layer, not written if empty */
+  std::string output;
+};
+
+/* Usage string for the options below */
+inline const char* options_2d_usage() {
+
+  return "[--x-points <N>] [--y-points <N>] [--t-points <N>] [--tau <step>] "
+         "[--scheme lf|lw|upwind] [--output <file>]";
+}
+
+/*
+ * Parse command line options given as '--name value' pairs.
+ * Throws std::invalid_argument on unknown or malformed option.
+ */
+inline Solver_options_2d parse_options_2d(int argc, char** argv) {
+
+  Solver_options_2d options;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[arg_idx + 1];
+
+    if (name == "--x-points") {
+      options.x_points = std::stoull(value);
+    } else if (name == "--y-points") {
+      options.y_points = std::stoull(value);
+    } else if (name == "--t-points") {
+      options.t_points = std::stoull(value);
+    } else if (name == "--tau") {
+      options.tau = std::stod(value);
+    } else if (name == "--scheme") {
+      options.scheme = scheme_from_string(value);
+    } else if (name == "--output") {
+      options.output = value;
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.x_points < 3 || options.y_points < 3 || options.t_points < 2) {
+    throw std::invalid_argument("grid is too small");
+  }
+
+  if (!(options.tau > 0)) {
+    throw std::invalid_argument("time step must be positive");
+  }
+
+  if (options.scheme == Scheme::implicit) {
+    throw std::invalid_argument("implicit scheme is not supported in 2D");
+  }
+
+  return options;
+}
+
+#endif // OPTIONS_2D_HPP
@@ -0,0 +1,141 @@
+#ifndef TRIDIAG_HPP
+#define TRIDIAG_HPP
+
+#include <stdint.h>
+#include <vector>
+
+namespace TRIDIAG {
+
+/* Row of the tridiagonal system: a * x[i-1] + b * x[i] + c * x[i+1] = d */
+struct Row {
+
+  double a;
+  double b;
+  double c;
+  double d;
+};
+
+/*
+ * Thomas algorithm. Solves system of n rows, a of the first
+ * row and c of the last one are ignored. Rows are overwritten.
+ */
+inline void thomas(Row* rows, uint64_t n, double* x) {
+
+  for (uint64_t idx = 1; idx < n; ++idx) {
+
+    double coeff = rows[idx].a / rows[idx-1].b;
+    rows[idx].b -= coeff * rows[idx-1].c;
+    rows[idx].d -= coeff * rows[idx-1].d;
+  }
+
+  x[n-1] = rows[n-1].d / rows[n-1].b;
+
+  for (uint64_t idx = n-1; idx-- > 0;) {
+    x[idx] = (rows[idx].d - rows[idx].c * x[idx+1]) / rows[idx].b;
+  }
+}
+
+/*
+ * Partitioned solver of the tridiagonal system distributed in blocks
+ * of consecutive rows between executors.
+ *
+ * Each block eliminates its interior unknowns, expressing them through
+ * the first and the last unknowns of the block:
+ *   x[i] = y[i] + v[i] * x_first + w[i] * x_last.
+ * Substitution of these into the first and the last rows of the block
+ * gives two rows of the reduced system. Reduced rows of all blocks,
+ * ordered by blocks, form a tridiagonal system of 2 * nblocks unknowns
+ * (x_first, x_last of each block), which is solved by any executor.
+ * Then each block expands the solution back to its interior.
+ */
+class Partition {
+
+  /* Interior representation through the first and the last unknowns */
+  std::vector<double> y;
+  std::vector<double> v;
+  std::vector<double> w;
+
+  /* Scratch for local solves */
+  std::vector<Row> scratch;
+
+public:
+
+  /*
+   * Eliminate interior of the block of n >= 2 rows.
+   * a of the first row couples block with the last unknown of the previous block,
+   * c of the last row couples it with the first unknown of the next block.
+   */
+  void reduce(const Row* rows, uint64_t n, Row reduced[2]) {
+
+    uint64_t n_int = n - 2;
+
+    y.resize(n_int);
+    v.resize(n_int);
+    w.resize(n_int);
+    scratch.resize(n_int);
+
+    if (n_int != 0) {
+
+      /* Interior rows with the right-hand side: d, -a * x_first, -c * x_last */
+      interior_solve(rows + 1, n_int, y.data(), [](const Row& row, uint64_t, uint64_t) {
+        return row.d;
+      });
+      interior_solve(rows + 1, n_int, v.data(), [](const Row& row, uint64_t idx, uint64_t) {
+        return (idx == 0)? -row.a : 0.;
+      });
+      interior_solve(rows + 1, n_int, w.data(), [](const Row& row, uint64_t idx, uint64_t last) {
+        return (idx == last)? -row.c : 0.;
+      });
+    }
+
+    /* x[1] and x[n-2] through x_first and x_last */
+    double y1 = (n_int)? y[0] : 0.,       v1 = (n_int)? v[0] : 0.,       w1 = (n_int)? w[0] : 1.;
+    double yl = (n_int)? y[n_int-1] : 0., vl = (n_int)? v[n_int-1] : 1., wl = (n_int)? w[n_int-1] : 0.;
+
+    const Row& first = rows[0];
+    const Row& last  = rows[n-1];
+
+    /* a * x_last_prev + b * x_first + c * x_last = d */
+    reduced[0] = Row{ first.a, first.b + first.c * v1, first.c * w1, first.d - first.c * y1 };
+
+    /* a * x_first + b * x_last + c * x_first_next = d */
+    reduced[1] = Row{ last.a * vl, last.b + last.a * wl, last.c, last.d - last.a * yl };
+  }
+
+  /* Restore solution of the block from its first and last unknowns */
+  void expand(double first, double last, double* x, uint64_t n) const {
+
+    x[0] = first;
+
+    for (uint64_t idx = 0; idx + 2 < n; ++idx) {
+      x[idx+1] = y[idx] + v[idx] * first + w[idx] * last;
+    }
+
+    x[n-1] = last;
+  }
+
+private:
+
+  template <typename Rside>
+  void interior_solve(const Row* rows, uint64_t n, double* x, Rside rside) {
+
+    for (uint64_t idx = 0; idx < n; ++idx) {
+
+      scratch[idx] = rows[idx];
+      scratch[idx].d = rside(rows[idx], idx, n-1);
+    }
+
+    thomas(scratch.data(), n, x);
+  }
+};
+
+/* Solve reduced system of 2 * nblocks rows, ordered by blocks */
+inline void solve_reduced(std::vector<Row>& reduced, std::vector<double>& x) {
+
+  x.resize(reduced.size());
+  thomas(reduced.data(), reduced.size(), x.data());
+}
+
+} // namespace TRIDIAG
+
+#endif // TRIDIAG_HPP
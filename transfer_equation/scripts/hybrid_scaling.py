@@ -0,0 +1,80 @@
+#!/usr/bin/python3
+
+import sys
+import os
+import re
+import shlex
+import argparse
+import subprocess
+
+# ==================
+
+
+def parse_args(argv):
+    """
+    Parse sys.argv for arguments of prog.
+    """
+    parser = argparse.ArgumentParser(
+        description="Compare pure MPI and hybrid MPI+OpenMP layouts of the transfer equation solver")
+
+    parser.add_argument("--build", default="build", help="build directory with 'parallel' and 'hybrid'")
+    parser.add_argument("--cores", default="1,2,4,8", help="comma separated total numbers of cores")
+    parser.add_argument("--threads", type=int, default=4, help="OpenMP threads per rank in hybrid layout")
+    parser.add_argument("--reps", type=int, default=3, help="repetitions of each run, minimum time is taken")
+    parser.add_argument("--mpirun", default="mpirun", help="MPI launcher with its options")
+    parser.add_argument("solver_args", nargs=argparse.REMAINDER, help="options passed to the solver")
+
+    args = parser.parse_args(argv[1:])
+    args.cores = [int(cores) for cores in args.cores.split(",")]
+    args.mpirun = shlex.split(args.mpirun)
+
+    if args.solver_args[:1] == ["--"]:
+        args.solver_args = args.solver_args[1:]
+
+    if args.threads < 1 or args.reps < 1:
+        print("Domain error: threads and reps must be positive")
+        sys.exit(1)
+
+    return args
+
+
+# ------------------
+
+
+def run(args, target, ranks, threads):
+    """
+    Run solver and return minimal elapsed time over repetitions.
+    """
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    cmd = args.mpirun + ["-n", str(ranks), "--bind-to", "none",
+           os.path.join(args.build, target)] + args.solver_args
+
+    best = None
+
+    for _ in range(args.reps):
+        out = subprocess.run(cmd, env=env, capture_output=True, text=True, check=True).stdout
+        elapsed = float(re.search(r"Elapsed: (\S+) sec", out).group(1))
+        best = elapsed if best is None else min(best, elapsed)
+
+    return best
+
+
+# ==================
+
+args = parse_args(sys.argv)
+
+print("layout,ranks,threads,cores,time,speedup,efficiency")
+
+base = run(args, "parallel", 1, 1)
+
+for cores in args.cores:
+
+    layouts = [("mpi", "parallel", cores, 1)]
+
+    if cores % args.threads == 0:
+        layouts.append(("hybrid", "hybrid", cores // args.threads, args.threads))
+
+    for layout, target, ranks, threads in layouts:
+        time = run(args, target, ranks, threads)
+        speedup = base / time
+        print(f"{layout},{ranks},{threads},{cores},{time:.6f},{speedup:.3f},{speedup / cores:.3f}")
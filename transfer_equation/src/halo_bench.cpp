@@ -0,0 +1,208 @@
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+#include "halo_exchange.hpp"
+
+/*
+ * Per-step cost of the halo exchange of the explicit solver without computations.
+ * Processes form the same chain as the solver: neighbours are rank+1 and rank-1,
+ * the end processes have one neighbour. Each step is one exchange done by:
+ * - sendrecv   - two blocking MPI_Sendrecv, one per direction;
+ * - isend      - MPI_Irecv/MPI_Isend created anew and MPI_Waitall, as the solver did before;
+ * - persistent - MPI_Startall/MPI_Waitall of the requests created once.
+ * Reported time of a step is the median over the steps of the slowest process.
+ */
+
+static const char* Patterns[] = {"sendrecv", "isend", "persistent"};
+
+struct Bench_options {
+
+  /* Halo depths, points sent to each neighbour per step */
+  std::vector<int> depths = {1, 16, 256, 4096};
+
+  uint64_t warmup = 100;
+  uint64_t steps  = 10000;
+};
+
+static const char* options_usage() {
+  return "[--depths <points,...>] [--warmup <N>] [--steps <N>]";
+}
+
+/* Throws std::invalid_argument on unknown or malformed option */
+static Bench_options parse_options(int argc, char** argv) {
+
+  Bench_options options;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx += 2) {
+
+    std::string name = argv[arg_idx];
+
+    if (arg_idx + 1 >= argc) {
+      throw std::invalid_argument("missing value for option " + name);
+    }
+
+    std::string value = argv[arg_idx + 1];
+
+    if (name == "--warmup") {
+      options.warmup = std::stoull(value);
+    } else if (name == "--steps") {
+      options.steps = std::stoull(value);
+    } else if (name == "--depths") {
+
+      options.depths.clear();
+
+      std::istringstream stream(value);
+      std::string depth;
+
+      while (std::getline(stream, depth, ',')) {
+
+        options.depths.push_back(std::stoi(depth));
+
+        if (options.depths.back() <= 0) {
+          throw std::invalid_argument("depths must be positive");
+        }
+      }
+
+    } else {
+      throw std::invalid_argument("unknown option " + name);
+    }
+  }
+
+  if (options.steps == 0 || options.depths.empty()) {
+    throw std::invalid_argument("no steps or depths given");
+  }
+
+  return options;
+}
+
+/* Run 'warmup' untimed and 'steps' timed exchanges, returns the median step time */
+template <typename Exchange>
+static double median_step(const Bench_options& options, Exchange exchange) {
+
+  for (uint64_t step = 0; step < options.warmup; ++step) {
+    exchange();
+  }
+
+  int res = MPI_Barrier(MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  std::vector<double> samples(options.steps);
+
+  for (uint64_t step = 0; step < options.steps; ++step) {
+
+    double start = MPI_Wtime();
+    exchange();
+    samples[step] = MPI_Wtime() - start;
+  }
+
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+  return samples[samples.size() / 2];
+}
+
+static double measure(const std::string& pattern, const Bench_options& options, int depth,
+                      int lft_neigh, int rgt_neigh) {
+
+  std::vector<double> send_buf(2 * depth, 1.);
+  std::vector<double> recv_buf(2 * depth);
+
+  double* send = send_buf.data();
+  double* recv = recv_buf.data();
+
+  if (pattern == "sendrecv") {
+
+    return median_step(options, [&]() {
+
+      /* First points go to the right neighbour, points after the chunk come from the left one */
+      int res = MPI_Sendrecv(&send[0], depth, MPI_DOUBLE, rgt_neigh, Halo_tag,
+                             &recv[depth], depth, MPI_DOUBLE, lft_neigh, Halo_tag,
+                             MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      EXIT_ON_MPI_FAILURE(res);
+
+      res = MPI_Sendrecv(&send[depth], depth, MPI_DOUBLE, lft_neigh, Halo_tag,
+                         &recv[0], depth, MPI_DOUBLE, rgt_neigh, Halo_tag,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      EXIT_ON_MPI_FAILURE(res);
+    });
+  }
+
+  if (pattern == "isend") {
+
+    return median_step(options, [&]() {
+      Halo_requests requests = start_halo_exchange(send, recv, depth, lft_neigh, rgt_neigh);
+      MPI::wait_all(requests);
+    });
+  }
+
+  Halo_requests halo = init_halo_exchange(send, recv, depth, lft_neigh, rgt_neigh);
+
+  return median_step(options, [&]() {
+    MPI::start_all(halo);
+    MPI::wait_all(halo);
+  });
+}
+
+int main(int argc, char** argv) {
+
+  MPI::MPI_env mpi_env(argc, argv);
+
+  int size, rank;
+
+  int res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Bench_options options;
+
+  try {
+
+    options = parse_options(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid arguments: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    }
+
+    return EXIT_FAILURE;
+  }
+
+  /* Same neighbours as in the solver */
+  int lft_neigh = (rank + 1 < size)? rank + 1 : MPI_PROC_NULL;
+  int rgt_neigh = (rank > 0)? rank - 1 : MPI_PROC_NULL;
+
+  if (rank == 0) {
+    std::cout << "Processes: " << size << ", steps: " << options.steps << "\n";
+    std::cout << std::left << std::setw(12) << "pattern" << std::right << std::setw(8) << "depth"
+              << std::setw(14) << "step, us" << "\n";
+  }
+
+  for (int depth : options.depths) {
+    for (const char* pattern : Patterns) {
+
+      double step = measure(pattern, options, depth, lft_neigh, rgt_neigh);
+
+      double slowest;
+      res = MPI_Reduce(&step, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+      EXIT_ON_MPI_FAILURE(res);
+
+      if (rank == 0) {
+        std::cout << std::left << std::setw(12) << pattern << std::right << std::setw(8) << depth
+                  << std::fixed << std::setprecision(3) << std::setw(14) << slowest * 1e6
+                  << std::defaultfloat << std::endl;
+      }
+    }
+  }
+
+  return 0;
+}
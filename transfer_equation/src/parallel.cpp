@@ -1,23 +1,706 @@
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include <new>
 #include <cmath>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <memory>
 
 #include "mpi.h"
 #include "mpi_support.hpp"
 
+#ifdef HYBRID
+#include <omp.h>
+#endif
+
 #include "comp_math.hpp"
+#include "options.hpp"
+#include "field_mpi_io.hpp"
+#include "decomposition_mpi.hpp"
+#include "checkpoint.hpp"
+#include "shm_mpi.hpp"
+#include "halo_exchange.hpp"
+
+/* Number of blocking exchanges used to estimate the cost of a single one */
+static const unsigned Calib_iters = 100U;
+
+/*
+ * Halo exchange through the shared memory of the nodes on one machine.
+ * Segment of each node holds the number of the exchanges it has published
+ * and its border points in the layout of 'send_buf', in two buffers used
+ * by the even and odd exchanges: before the node writes the exchange 'n' 
+ * its neighbours have published 'n-1', so they have read 'n-2' already.
+ */
+struct Shm_halo {
+
+  MPI_Win win = MPI_WIN_NULL;
+
+  SHM::counted_segment<double> own;
+
+  /* Segments of the neighbours, null if there is no neighbour */
+  SHM::counted_segment<const double> lft;
+  SHM::counted_segment<const double> rgt;
+};
+
+static Shm_halo create_shm_halo(MPI_Comm node, int depth, int lft_neigh, int rgt_neigh) {
+
+  Shm_halo halo;
+
+  int res = SHM::allocate_counted(node, 2 * 2 * depth * sizeof(double), &halo.win, &halo.own);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (lft_neigh != MPI_PROC_NULL) {
+    res = SHM::counted_segment_of(halo.win, lft_neigh, &halo.lft);
+    EXIT_ON_MPI_FAILURE(res);
+  }
+
+  if (rgt_neigh != MPI_PROC_NULL) {
+    res = SHM::counted_segment_of(halo.win, rgt_neigh, &halo.rgt);
+    EXIT_ON_MPI_FAILURE(res);
+  }
+
+  return halo;
+}
+
+/* Publish the border points of the exchange 'exchange' */
+static void shm_start_exchange(Shm_halo& halo, const double* send_buf, int depth, uint64_t exchange) {
+
+  std::copy(send_buf, send_buf + 2 * depth, halo.own.data + (exchange % 2) * 2 * depth);
+  SHM::publish(*halo.own.cnt, exchange + 1);
+}
+
+/* Wait for the neighbours to publish the exchange 'exchange' and read their border points */
+static void shm_finish_exchange(const Shm_halo& halo, double* recv_buf, int depth, uint64_t exchange) {
+
+  uint64_t offset = (exchange % 2) * 2 * depth;
+
+  /* Points before the chunk are the last points of the right neighbour */
+  if (halo.rgt.cnt != nullptr) {
+
+    SHM::wait_for(*halo.rgt.cnt, exchange + 1);
+    std::copy(halo.rgt.data + offset + depth, halo.rgt.data + offset + 2 * depth, recv_buf);
+  }
+
+  /* Points after the chunk are the first points of the left neighbour */
+  if (halo.lft.cnt != nullptr) {
+
+    SHM::wait_for(*halo.lft.cnt, exchange + 1);
+    std::copy(halo.lft.data + offset, halo.lft.data + offset + depth, recv_buf + depth);
+  }
+}
+
+/* 
+ * Measure average time of the same exchange done 
+ * without overlapping it with computations 
+ */
+static double calibrate_blocking_exchange(Halo_requests& halo) {
+
+  int res = MPI_Barrier(MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  double start = MPI_Wtime();
+
+  for (unsigned iter = 0; iter < Calib_iters; ++iter) {
+
+    MPI::start_all(halo);
+    MPI::wait_all(halo);
+  }
+
+  return (MPI_Wtime() - start) / Calib_iters;
+}
+
+/* The same for the shared memory transport, the calibration uses up the exchange numbers */
+static double calibrate_blocking_exchange(Shm_halo& halo, const double* send_buf, double* recv_buf,
+                                          int depth, uint64_t& exchange) {
+
+  int res = MPI_Barrier(MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  double start = MPI_Wtime();
+
+  for (unsigned iter = 0; iter < Calib_iters; ++iter, ++exchange) {
+
+    shm_start_exchange(halo, send_buf, depth, exchange);
+    shm_finish_exchange(halo, recv_buf, depth, exchange);
+  }
+
+  return (MPI_Wtime() - start) / Calib_iters;
+}
+
+/* Print share of the exchange time hidden behind computations of the slowest node */
+static void report_hidden_exchange(int rank, double blocking_time, double exposed_time) {
+
+  double times[2] = { blocking_time, exposed_time };
+  double max_times[2];
+
+  int res = MPI_Reduce(times, max_times, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank != 0) {
+    return;
+  }
+
+  double hidden = (max_times[0] > 0)? 1. - max_times[1] / max_times[0] : 0;
+
+  std::cout << "Exchange (blocking estimate): " << max_times[0] << " sec \n";
+  std::cout << "Exchange (exposed): " << max_times[1] << " sec \n";
+  std::cout << "Exchange hidden: " << 100. * std::clamp(hidden, 0., 1.) << " % \n";
+}
+
+/* 
+ * Print total number of messages sent by all nodes and the amount of 
+ * redundant computations made in the halo regions, compared 
+ * to exchanging single points every time step. With the shared memory
+ * transport a halo read from the segment of a neighbour counts as a message.
+ */
+static void report_halo_cost(int rank, int size, uint64_t halo_depth, uint64_t t_points,
+                             bool shm, unsigned long long messages, unsigned long long computed, 
+                             unsigned long long useful) {
+
+  unsigned long long counters[2] = { messages, computed };
+  unsigned long long total[2];
+
+  int res = MPI_Reduce(counters, total, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank != 0) {
+    return;
+  }
+
+  /* Two messages per each pair of neighbours in each direction every time step */
+  unsigned long long messages_single = 2ULL * (size - 1) * (t_points - 1);
+
+  std::cout << "Halo depth: " << halo_depth << "\n";
+  std::cout << (shm? "Halos read from shared memory: " : "Messages sent: ") 
+            << total[0] << " (" << messages_single 
+                                  << " with halo depth 1) \n";
+  std::cout << "Points computed: " << total[1] << " (" << useful << " useful, " 
+            << 100. * (total[1] - useful) / useful << " % redundant) \n";
+}
+
+/* Part of the grid assigned to the node */
+struct Chunk {
+
+  /* Points [x_idx_begin; x_idx_end) are owned by the node */
+  uint64_t x_idx_begin;
+  uint64_t x_idx_end;
+
+  /* Points [compute_begin; compute_end) are computed by the node, boundaries are excluded */
+  uint64_t compute_begin;
+  uint64_t compute_end;
+
+  /* Neighbours owning points after and before the chunk */
+  int lft_neigh;
+  int rgt_neigh;
+};
+
+/* Statistics of the exchanges made during the time loop */
+struct Exchange_stats {
+
+  /* Estimated time of the same exchanges made without overlapping */
+  double blocking_time = 0;
+
+  /* Time spent waiting for the exchanges to complete */
+  double exposed_time = 0;
+
+  /* Counters for comparison with the single point halo */
+  unsigned long long messages = 0;
+  unsigned long long computed = 0;
+};
+
+/* Create datatype of a single layer point, points of the same layer are strided by t_points */
+static MPI_Datatype create_layer_point_type(const Comp_scheme& comp_scheme) {
+
+  MPI_Datatype layer_point;
+  int res = MPI_Type_create_resized(MPI_DOUBLE, 0, comp_scheme.t_points() * sizeof(double), 
+                                    &layer_point);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&layer_point);
+  EXIT_ON_MPI_FAILURE(res);
+
+  return layer_point;
+}
+
+/* 
+ * Gather layer 'k' from all nodes' chunks into node №0 with a single 
+ * MPI_Gatherv. Points of the layer are strided by t_points in memory, 
+ * so they are described by MPI_DOUBLE resized to the stride.
+ */
+static void gather_layer(Comp_scheme& comp_scheme, uint64_t k, const DECOMP::offsets& offsets,
+                         int size, int rank) {
+
+  MPI_Datatype layer_point = create_layer_point_type(comp_scheme);
+
+  std::vector<int> counts(size);
+  std::vector<int> displs(size);
+
+  for (int node = 0; node < size; ++node) {
+
+    counts[node] = static_cast<int>(offsets[node + 1] - offsets[node]);
+    displs[node] = static_cast<int>(offsets[node]);
+  }
+
+  double* layer = comp_scheme.point_ptr(0, k);
+
+  int res;
+
+  if (rank == 0) {
+
+    res = MPI_Gatherv(MPI_IN_PLACE, 0, layer_point, layer, counts.data(), displs.data(), 
+                      layer_point, 0, MPI_COMM_WORLD);
+  } else {
+
+    res = MPI_Gatherv(layer + displs[rank] * comp_scheme.t_points(), counts[rank], layer_point, 
+                      nullptr, nullptr, nullptr, layer_point, 0, MPI_COMM_WORLD);
+  }
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_free(&layer_point);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+/*
+ * Gather layer 'k' into node №0 through the shared memory: every node copies 
+ * its points into its segment, node №0 reads the segments of the others.
+ */
+static void gather_layer_shm(Comp_scheme& comp_scheme, uint64_t k, const DECOMP::offsets& offsets,
+                             MPI_Comm node, int size, int rank) {
+
+  uint64_t x_idx_begin = offsets[rank];
+  uint64_t x_idx_end   = offsets[rank + 1];
+
+  MPI_Win win;
+  double* own;
+
+  int res = SHM::allocate(node, (rank == 0)? 0 : (x_idx_end - x_idx_begin) * sizeof(double), 
+                          &win, &own);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank != 0) {
+
+    for (uint64_t m = x_idx_begin; m < x_idx_end; ++m) {
+      own[m - x_idx_begin] = comp_scheme.get(m, k);
+    }
+  }
+
+  res = SHM::sync(win, node);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank == 0) {
+
+    for (int neigh = 1; neigh < size; ++neigh) {
+
+      const double* values;
+      res = SHM::segment(win, neigh, &values);
+      EXIT_ON_MPI_FAILURE(res);
+
+      for (uint64_t m = offsets[neigh]; m < offsets[neigh + 1]; ++m) {
+        comp_scheme.set(m, k, values[m - offsets[neigh]]);
+      }
+    }
+  }
+
+  /* Segments are read before the window is freed */
+  res = SHM::free_window(&win);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+/* 
+ * Collectively write layer 'k' into the binary field file,
+ * every node writes its own chunk [x_idx_begin; x_idx_end)
+ */
+static void write_layer(Comp_scheme& comp_scheme, uint64_t k, const std::string& path,
+                        uint64_t x_idx_begin, uint64_t x_idx_end) {
+
+  MPI_Datatype layer_point = create_layer_point_type(comp_scheme);
+
+  FIELD::header header = FIELD::make_header_1d(comp_scheme.x_points(), comp_scheme.h());
+
+  MPI_File file;
+  int res = FIELD::mpi_create(MPI_COMM_WORLD, path.c_str(), header, &file);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = FIELD::mpi_write_all(file, x_idx_begin, comp_scheme.point_ptr(x_idx_begin, k), 
+                             static_cast<int>(x_idx_end - x_idx_begin), layer_point);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = FIELD::mpi_close(&file);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_free(&layer_point);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+/* Periodic checkpoints of the time loop, disabled if there is no writer */
+struct Checkpointing {
+
+  CHECKPOINT::Writer* writer = nullptr;
+  uint64_t interval = 0;
+
+  /* Step of the last checkpoint or the step the loop started from */
+  uint64_t last = 0;
+
+  /* Time the loop was stalled by the checkpoints: copying and waiting for the previous one */
+  double stall_time = 0;
+};
+
+/* Start writing the checkpoint of the layer 't_idx' if the interval has passed */
+static void checkpoint_layer(Checkpointing& ckpt, const Comp_scheme& comp_scheme, uint64_t t_idx) {
+
+  if (ckpt.writer == nullptr || t_idx - ckpt.last < ckpt.interval) {
+    return;
+  }
+
+  double start = MPI_Wtime();
+
+  ckpt.writer->start(t_idx, [&comp_scheme](uint64_t m, uint64_t k) {
+    return comp_scheme.get(m, k);
+  });
+
+  ckpt.stall_time += MPI_Wtime() - start;
+  ckpt.last = t_idx;
+}
+
+/*
+ * Decomposition of the latest checkpoint present on all nodes: chunks of the nodes
+ * are taken from the headers of their files and have to cover the grid one after another.
+ * Empty if there is no such checkpoint. 'expected' gives the run, its chunk is ignored.
+ */
+static DECOMP::offsets checkpoint_offsets(const std::string& prefix, 
+                                          const CHECKPOINT::Header& expected, int size) {
+
+  const unsigned Generations = CHECKPOINT::Generations;
+
+  /* Step, first and past the last point of every generation, zero step without the file */
+  const unsigned Fields = 3;
+  uint64_t own[Generations * Fields] = {};
+
+  for (unsigned gen = 0; gen < Generations; ++gen) {
+
+    CHECKPOINT::Header header;
+
+    if (CHECKPOINT::read_header(prefix, gen, expected, header)) {
+      own[gen * Fields]     = header.step;
+      own[gen * Fields + 1] = header.x_idx_begin;
+      own[gen * Fields + 2] = header.x_idx_end;
+    }
+  }
+
+  std::vector<uint64_t> all(Generations * Fields * size);
+
+  int res = MPI_Allgather(own, Generations * Fields, MPI_UINT64_T, 
+                          all.data(), Generations * Fields, MPI_UINT64_T, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Candidates are the steps of node 0, every node sees the same data and makes the same choice */
+  DECOMP::offsets offsets;
+  uint64_t latest = 0;
+
+  for (unsigned gen = 0; gen < Generations; ++gen) {
+
+    uint64_t step = all[gen * Fields];
+
+    if (step <= latest) {
+      continue;
+    }
+
+    DECOMP::offsets candidate(size + 1, 0);
+    bool everywhere = true;
+
+    for (int node = 0; node < size && everywhere; ++node) {
+
+      everywhere = false;
+
+      for (unsigned node_gen = 0; node_gen < Generations && !everywhere; ++node_gen) {
+
+        const uint64_t* entry = &all[(node * Generations + node_gen) * Fields];
+
+        if (entry[0] == step && entry[1] == candidate[node] && entry[2] > entry[1]) {
+          candidate[node + 1] = entry[2];
+          everywhere = true;
+        }
+      }
+    }
+
+    if (everywhere && candidate[size] == expected.x_points) {
+      latest  = step;
+      offsets = candidate;
+    }
+  }
+
+  return offsets;
+}
+
+/*
+ * Load the latest checkpoint present on all nodes into the chunk.
+ * Returns its step or 0 if there is no such checkpoint.
+ */
+static uint64_t restore_checkpoint(Comp_scheme& comp_scheme, const std::string& prefix,
+                                   const CHECKPOINT::Header& expected, int size) {
+
+  const unsigned Generations = CHECKPOINT::Generations;
+
+  uint64_t steps[Generations] = {};
+  std::vector<double> values[Generations];
+
+  for (unsigned gen = 0; gen < Generations; ++gen) {
+
+    CHECKPOINT::Header header;
+
+    if (CHECKPOINT::read(prefix, gen, expected, header, values[gen])) {
+      steps[gen] = header.step;
+    }
+  }
+
+  std::vector<uint64_t> all_steps(Generations * size);
+
+  int res = MPI_Allgather(steps, Generations, MPI_UINT64_T, 
+                          all_steps.data(), Generations, MPI_UINT64_T, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* The latest of own steps which every node has, the same on all nodes */
+  uint64_t step = 0;
+  unsigned step_gen = 0;
+
+  for (unsigned gen = 0; gen < Generations; ++gen) {
+
+    bool everywhere = (steps[gen] > step);
+
+    for (int node = 0; node < size && everywhere; ++node) {
+
+      auto node_begin = all_steps.begin() + node * Generations;
+      everywhere = std::find(node_begin, node_begin + Generations, steps[gen]) != node_begin + Generations;
+    }
+
+    if (everywhere) {
+      step = steps[gen];
+      step_gen = gen;
+    }
+  }
+
+  if (step != 0) {
+
+    for (uint64_t m = expected.x_idx_begin; m < expected.x_idx_end; ++m) {
+      comp_scheme.set(m, step, values[step_gen][m - expected.x_idx_begin]);
+    }
+  }
 
-static const unsigned Msg_tag = 5U;
+  return step;
+}
+
+/* 
+ * Time loop of the explicit schemes. Nodes exchange 'halo_depth' points 
+ * of the current layer with neighbours and then advance 'halo_depth' 
+ * layers locally, recomputing the shrinking halo region.
+ */
+static Exchange_stats run_explicit(Comp_scheme& comp_scheme, const Chunk& chunk, 
+                                   uint64_t halo_depth, uint64_t t_begin, Checkpointing& ckpt,
+                                   MPI_Comm node) {
+
+  uint64_t x_points = comp_scheme.x_points();
+  uint64_t t_points = comp_scheme.t_points();
+
+  auto [x_idx_begin, x_idx_end, compute_begin, compute_end, lft_neigh, rgt_neigh] = chunk;
+
+  int depth = static_cast<int>(halo_depth);
+
+  std::vector<double> send_buf(2 * halo_depth);
+  std::vector<double> recv_buf(2 * halo_depth);
+
+  /* Halos go through the shared memory if the nodes are on one machine */
+  Shm_halo shm_halo;
+  Halo_requests halo;
+
+  uint64_t exchange = 0;
+
+  /* Cost of the blocking exchange, used as a reference for the overlapped one */
+  double blocking_exchange_time;
+
+  if (node != MPI_COMM_NULL) {
+
+    shm_halo = create_shm_halo(node, depth, lft_neigh, rgt_neigh);
+    blocking_exchange_time = calibrate_blocking_exchange(shm_halo, send_buf.data(), recv_buf.data(),
+                                                         depth, exchange);
+  } else {
+
+    /* Neighbours and buffers are the same every step, so the requests are set up once */
+    halo = init_halo_exchange(send_buf.data(), recv_buf.data(), depth, lft_neigh, rgt_neigh);
+    blocking_exchange_time = calibrate_blocking_exchange(halo);
+  }
+
+  Exchange_stats stats;
+
+  /* 
+   * Points next to the chunk borders depend on the neighbours' points, 
+   * the rest of the chunk can be computed while the exchange is in flight
+   */
+  uint64_t interior_begin = compute_begin + 1;
+  uint64_t interior_end   = (compute_end > interior_begin)? compute_end - 1 : interior_begin;
+
+  for (uint64_t t_idx = t_begin; t_idx < t_points-1; t_idx += halo_depth) {
+
+    /* Owned points of the current layer are complete */
+    checkpoint_layer(ckpt, comp_scheme, t_idx);
+
+    /* Number of time steps made until the next exchange */
+    uint64_t steps = std::min(halo_depth, t_points - 1 - t_idx);
+
+    /* Exchange points of the current layer with neighbours */
+
+    for (uint64_t idx = 0; idx < halo_depth; ++idx) {
+      send_buf[idx]              = comp_scheme.get(x_idx_begin + idx, t_idx);
+      send_buf[halo_depth + idx] = comp_scheme.get(x_idx_end - halo_depth + idx, t_idx);
+    }
+
+    if (node != MPI_COMM_NULL) {
+      shm_start_exchange(shm_halo, send_buf.data(), depth, exchange);
+    } else {
+      MPI::start_all(halo);
+    }
+
+    /* Compute interior of the chunk while messages are in flight */
+    comp_scheme.compute_range(interior_begin, interior_end, t_idx);
+
+    double wait_start = MPI_Wtime();
+
+    if (node != MPI_COMM_NULL) {
+      shm_finish_exchange(shm_halo, recv_buf.data(), depth, exchange);
+    } else {
+      MPI::wait_all(halo);
+    }
+
+    stats.messages += (lft_neigh != MPI_PROC_NULL) + (rgt_neigh != MPI_PROC_NULL);
+
+    stats.exposed_time  += MPI_Wtime() - wait_start;
+    stats.blocking_time += blocking_exchange_time;
+
+    ++exchange;
+
+    /* Fill in halo points of the current layer */
+
+    for (uint64_t idx = 0; idx < halo_depth; ++idx) {
+
+      if (rgt_neigh != MPI_PROC_NULL) {
+        comp_scheme.set(x_idx_begin - halo_depth + idx, t_idx, recv_buf[idx]);
+      }
+
+      if (lft_neigh != MPI_PROC_NULL) {
+        comp_scheme.set(x_idx_end + idx, t_idx, recv_buf[halo_depth + idx]);
+      }
+    }
+
+    /* 
+     * Advance 'steps' layers locally. Each step the range computed
+     * shrinks by one point from each side, since the next layer 
+     * is required for one point narrower range.
+     */
+    for (uint64_t step = 0; step < steps; ++step) {
+
+      uint64_t ext = steps - 1 - step;
+
+      uint64_t range_begin = (rgt_neigh != MPI_PROC_NULL)? 
+                             std::max(compute_begin - ext, uint64_t{1}) : compute_begin;
+
+      uint64_t range_end   = (lft_neigh != MPI_PROC_NULL)? 
+                             std::min(compute_end + ext, x_points - 1) : compute_end;
+
+      if (step == 0) {
+
+        /* Compute chunk borders and the halo, interior is already computed */
+        comp_scheme.compute_range(range_begin, std::min(interior_begin, range_end), t_idx);
+        comp_scheme.compute_range(std::max(interior_end, interior_begin), range_end, t_idx);
+
+      } else {
+        comp_scheme.compute_range(range_begin, range_end, t_idx + step);
+      }
+
+      stats.computed += range_end - range_begin;
+    }
+  }
+
+  if (node != MPI_COMM_NULL) {
+
+    int res = SHM::free_window(&shm_halo.win);
+    EXIT_ON_MPI_FAILURE(res);
+  }
+
+  return stats;
+}
+
+/* 
+ * Time loop of the implicit scheme. Every step each node eliminates its part 
+ * of the layer system, reduced rows of all nodes are gathered by every node,
+ * the reduced system is solved redundantly and the chunk is restored from it.
+ */
+static Exchange_stats run_implicit(Comp_scheme& comp_scheme, const Chunk& chunk, 
+                                   int size, int rank, uint64_t t_begin, Checkpointing& ckpt) {
+
+  uint64_t t_points = comp_scheme.t_points();
+
+  /* Two rows of the reduced system per node */
+  std::vector<TRIDIAG::Row> reduced(2 * size);
+  std::vector<double> interface;
+
+  /* Row consists of four doubles */
+  const int Row_doubles = sizeof(TRIDIAG::Row) / sizeof(double);
+
+  Exchange_stats stats;
+
+  for (uint64_t t_idx = t_begin; t_idx < t_points-1; ++t_idx) {
+
+    checkpoint_layer(ckpt, comp_scheme, t_idx);
+
+    TRIDIAG::Row local[2];
+    comp_scheme.implicit_reduce(chunk.compute_begin, chunk.compute_end, t_idx, local);
+
+    double exchange_start = MPI_Wtime();
+
+    int res = MPI_Allgather(local, 2 * Row_doubles, MPI_DOUBLE, 
+                            reduced.data(), 2 * Row_doubles, MPI_DOUBLE, MPI_COMM_WORLD);
+    EXIT_ON_MPI_FAILURE(res);
+
+    double exchange_time = MPI_Wtime() - exchange_start;
+
+    stats.exposed_time  += exchange_time;
+    stats.blocking_time += exchange_time;
+    stats.messages      += 2 * (size - 1);
+    stats.computed      += chunk.compute_end - chunk.compute_begin;
+
+    TRIDIAG::solve_reduced(reduced, interface);
+
+    comp_scheme.implicit_expand(chunk.compute_begin, chunk.compute_end, t_idx, 
+                                interface[2 * rank], interface[2 * rank + 1]);
+  }
+
+  return stats;
+}
 
 int main(int argc, char **argv)
 {
   int res, rank, size;
 
-  /* Инициализация среды MPI */
-  res = MPI_Init(&argc, &argv);
+  /* 
+   * Инициализация среды MPI. Вызовы MPI выполняются только главным потоком 
+   * вне параллельных областей: в гибридной версии вычисления делятся между 
+   * потоками OpenMP, контрольные точки записываются отдельным потоком.
+   */
+  int provided;
+  res = MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
   EXIT_ON_MPI_FAILURE(res);
 
+  if (provided < MPI_THREAD_FUNNELED) {
+
+    std::cerr << "MPI implementation does not support MPI_THREAD_FUNNELED\n";
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
   /* Общее число процессов в коммуникаторе */
   res = MPI_Comm_size(MPI_COMM_WORLD, &size);
   EXIT_ON_MPI_FAILURE(res);
@@ -29,14 +712,48 @@ int main(int argc, char **argv)
   res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   EXIT_ON_MPI_FAILURE(res);
   
+  Solver_options options;
+
+  try {
+
+    options = parse_options(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid options: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    }
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
   Comp_scheme comp_scheme{
-    1e-3,     /* h        */
-    5e-6,     /* tau      */
-    10000008, /* x_points */
-    100,      /* t_points */
-    1e-2      /* a        */
+    1e-3,              /* h        */
+    options.tau,       /* tau      */
+    options.x_points,  /* x_points */
+    options.t_points,  /* t_points */
+    1e-2,              /* a        */
+    options.scheme     /* scheme   */
   };
 
+  /* Courant condition for the explicit schemes */
+  if (!comp_scheme.is_stable()) {
+
+    if (rank == 0) {
+      std::cerr << "Scheme is unstable with Courant number " << comp_scheme.courant() 
+                << ", decrease tau or use the implicit scheme\n";
+    }
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
   try {
 
     comp_scheme.allocate();
@@ -50,10 +767,88 @@ int main(int argc, char **argv)
   uint64_t x_points = comp_scheme.x_points();
   uint64_t t_points = comp_scheme.t_points();
   
-  uint64_t x_points_per_proc = x_points / size;
+  /* 
+   * Halo is received from the immediate neighbours only, 
+   * so it cannot be wider than the chunk 
+   */
+  uint64_t halo_depth = std::min(options.halo_depth, t_points - 1);
+
+  /* Implicit scheme requires solving the system for the whole layer every step */
+  if (comp_scheme.scheme() == Scheme::implicit && halo_depth > 1) {
+
+    if (rank == 0) {
+      std::cerr << "Implicit scheme requires halo depth 1\n";
+    }
+
+    comp_scheme.free();
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
+  /* 
+   * Chunk sizes are proportional to the node weights measured in the previous runs,
+   * or differ at most by one point without them. For the implicit scheme
+   * each node has to compute at least two points.
+   */
+  std::vector<double> weights;
+  res = DECOMP::mpi_load_weights(MPI_COMM_WORLD, options.balance, weights);
+  EXIT_ON_MPI_FAILURE(res);
+
+  uint64_t min_chunk = (comp_scheme.scheme() == Scheme::implicit)? 3 : halo_depth;
+
+  DECOMP::offsets offsets;
+
+  /* 
+   * Restarted run keeps the decomposition of its checkpoints: the weights are 
+   * updated after every run, so the chunks they give differ from the saved ones
+   */
+  bool ckpt_decomposition = false;
+
+  if (options.restart) {
+
+    CHECKPOINT::Header run_header = CHECKPOINT::make_header(
+      static_cast<uint32_t>(comp_scheme.scheme()), x_points, t_points, comp_scheme.tau(), 
+      size, rank, 0, 0);
+
+    offsets = checkpoint_offsets(options.checkpoint, run_header, size);
+
+    for (int idx = 0; idx < size && !offsets.empty(); ++idx) {
 
-  uint64_t x_idx_begin = x_points_per_proc * rank;
-  uint64_t x_idx_end   = x_points_per_proc * (rank + 1);
+      /* Halo depth of the restarted run does not fit into the saved chunks */
+      if (offsets[idx + 1] - offsets[idx] < min_chunk) {
+        offsets.clear();
+      }
+    }
+
+    ckpt_decomposition = !offsets.empty();
+  }
+
+  try {
+
+    if (!ckpt_decomposition) {
+      offsets = DECOMP::weighted_offsets(x_points, weights, min_chunk);
+    }
+
+  } catch (const std::invalid_argument&) {
+
+    if (rank == 0) {
+      std::cerr << "Grid of " << x_points << " points cannot be split into " << size 
+                << " chunks of at least " << min_chunk << " points\n";
+    }
+
+    comp_scheme.free();
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
+  uint64_t x_idx_begin = offsets[rank];
+  uint64_t x_idx_end   = offsets[rank + 1];
 
   uint64_t compute_begin = (x_idx_begin == 0)? 
                             x_idx_begin + 1 : x_idx_begin;
@@ -69,21 +864,18 @@ int main(int argc, char **argv)
 #endif
 
   /* u(0,x) = fi(x) */
-  Comp_scheme::bound_func_type fi  = [](double arg) -> double { return 1000. * std::sin(arg); };
+  auto fi  = [](double arg) -> double { return 1000. * std::sin(arg); };
   comp_scheme.set_boundary_coord(x_idx_begin, x_idx_end, fi);
 
-  /* u(t,0) = psi(t) */
-  Comp_scheme::bound_func_type psi = [](double arg) { return 100. * arg; };
+  /* u(t,0) = u(t,x_points-1) = psi(t) */
+  auto psi = [](double arg) { return 100. * arg; };
 
-  if (rank == min_rank) {
-    /* u(t,0) = u(t,x_points-1) = psi(t) */
-    comp_scheme.set_boundary_time(0, psi);
-  }
-
-  if (rank == max_rank) {
-    /* u(t,x_points-1) = psi(t) */
-    comp_scheme.set_boundary_time(x_points-1, psi);
-  }
+  /* 
+   * Every node keeps boundary values, 
+   * since deep halo may reach the boundaries 
+   */
+  comp_scheme.set_boundary_time(0, psi);
+  comp_scheme.set_boundary_time(x_points-1, psi);
 
   int lft_neigh = (rank == max_rank)? MPI_PROC_NULL : rank + 1;
   int rgt_neigh = (rank == min_rank)? MPI_PROC_NULL : rank - 1;
@@ -96,82 +888,155 @@ int main(int argc, char **argv)
                                       "MPI_PROC_NULL" : std::to_string(rgt_neigh)) << "\n";
 #endif
 
-  if (rank == 0) {
-    mpi_start_timer();
-  }
+  Chunk chunk{ x_idx_begin, x_idx_end, compute_begin, compute_end, lft_neigh, rgt_neigh };
 
-  for (uint64_t t_idx = 0; t_idx < t_points-1; ++t_idx) {
+  /* 
+   * Communicator of the nodes sharing memory for the 'shm' transport, 
+   * MPI_COMM_NULL for the messages. Ranks in it are the same as in MPI_COMM_WORLD.
+   */
+  MPI_Comm node = MPI_COMM_NULL;
 
-    /* Send points from previous iteration to neighbours */
+  if (options.transport == Transport::shm) {
 
-    double right_send = comp_scheme.get(x_idx_begin, t_idx-1);
-    res = MPI_Send(&right_send, 1, MPI_DOUBLE, rgt_neigh, Msg_tag, MPI_COMM_WORLD);
+    res = SHM::single_node_comm(MPI_COMM_WORLD, &node);
     EXIT_ON_MPI_FAILURE(res);
 
-    double left_send = comp_scheme.get(x_idx_end-1, t_idx-1);
-    res = MPI_Send(&left_send, 1, MPI_DOUBLE, lft_neigh, Msg_tag, MPI_COMM_WORLD);
-    EXIT_ON_MPI_FAILURE(res);
+    if (rank == 0) {
+      std::cout << ((node != MPI_COMM_NULL)? "Transport: shared memory\n" : 
+                    "Transport: not all nodes share memory, using messages\n");
+    }
+  }
 
-    /* Receive points from previous iteration from neighbours */
+  /* Checkpoints are valid only for the same grid, scheme and decomposition */
+  CHECKPOINT::Header ckpt_header = CHECKPOINT::make_header(
+    static_cast<uint32_t>(comp_scheme.scheme()), x_points, t_points, comp_scheme.tau(), 
+    size, rank, x_idx_begin, x_idx_end);
 
-    double right_recv = 0;
-    res = MPI_Recv(&right_recv, 1, MPI_DOUBLE, rgt_neigh, Msg_tag, 
-                                   MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    EXIT_ON_MPI_FAILURE(res);
+  uint64_t t_begin = 0;
 
-    double left_recv = 0;
-    res = MPI_Recv(&left_recv, 1, MPI_DOUBLE, lft_neigh, Msg_tag, 
-                                  MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    EXIT_ON_MPI_FAILURE(res);
+  if (options.restart) {
+
+    t_begin = restore_checkpoint(comp_scheme, options.checkpoint, ckpt_header, size);
+
+    if (rank == 0) {
 
-    /* Fill in neccessary previous iteration points for computing own chunk */
+      if (t_begin != 0) {
 
-    if (x_idx_begin != 0) {
-      comp_scheme.set(x_idx_begin - 1, t_idx - 1, right_recv);
+        std::cout << "Restarted from step " << t_begin << "\n";
+
+        if (ckpt_decomposition && !options.balance.empty()) {
+          std::cout << "Decomposition is taken from the checkpoint, weights of " 
+                    << options.balance << " are used from the next run\n";
+        }
+
+      } else {
+        std::cout << "No complete checkpoint found, starting from the beginning\n";
+      }
     }
+  }
+
+  std::unique_ptr<CHECKPOINT::Writer> ckpt_writer;
+
+  if (!options.checkpoint.empty()) {
+    ckpt_writer = std::make_unique<CHECKPOINT::Writer>(options.checkpoint, ckpt_header);
+  }
+
+  Checkpointing ckpt{ ckpt_writer.get(), options.checkpoint_interval, t_begin };
+
+  if (rank == 0) {
+
+  #ifdef HYBRID
+    std::cout << "Threads per node: " << omp_get_max_threads() << "\n";
+  #endif
+
+  }
+
+  MPI::stopwatch sw;
+  sw.start();
+
+  double loop_start = MPI_Wtime();
+
+  Exchange_stats stats;
+
+  try {
 
-    if (x_idx_end != x_points) {
-      comp_scheme.set(x_idx_end, t_idx - 1, left_recv);
+    stats = (comp_scheme.scheme() == Scheme::implicit)? 
+             run_implicit(comp_scheme, chunk, size, rank, t_begin, ckpt) :
+             run_explicit(comp_scheme, chunk, halo_depth, t_begin, ckpt, node);
+
+    /* Last checkpoint has to be complete before the files are used */
+    if (ckpt.writer != nullptr) {
+      ckpt.writer->wait();
     }
 
-    /* Compute chunk */
-    comp_scheme.compute_range(compute_begin, compute_end, t_idx);
+  } catch (const std::runtime_error& exc) {
+
+    std::cerr << "[" << rank << "] " << exc.what() << "\n";
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
   }
 
+  /* Waiting for the neighbours is caused by the imbalance, so it is not counted */
+  double compute_time = MPI_Wtime() - loop_start - stats.exposed_time;
+
   /* Wait for all of the chunks to be calculated */
   MPI_Barrier(MPI_COMM_WORLD);
 
   if (rank == 0) {
-    std::cout << "Elapsed: " << mpi_stop_timer() << " sec \n";
+    std::cout << "Elapsed: " << sw.stop() << " sec \n";
   }
 
-  if (rank == 0) {
+  report_hidden_exchange(rank, stats.blocking_time, stats.exposed_time);
+
+  /* Update node weights for the next run from the measured compute times */
+  std::vector<double> compute_times;
+  res = DECOMP::mpi_rebalance(MPI_COMM_WORLD, options.balance, offsets, weights, 
+                              compute_time, compute_times);
+  EXIT_ON_MPI_FAILURE(res);
 
-    /* Receive calculated values from all other nodes */
-    for (int node = 1; node < size; ++node) {
+  if (rank == 0) {
+    std::cout << "Load imbalance (max / mean compute time): " 
+              << DECOMP::imbalance(compute_times) << "\n";
+  }
 
-      uint64_t begin = x_points_per_proc * node;
-      uint64_t end   = x_points_per_proc * (node + 1);
+  if (comp_scheme.scheme() != Scheme::implicit) {
+    report_halo_cost(rank, size, halo_depth, t_points - t_begin, node != MPI_COMM_NULL, 
+                     stats.messages, stats.computed, (x_points - 2) * (t_points - 1 - t_begin));
+  }
 
-      for (uint64_t x_idx = begin; x_idx < end; ++x_idx) {
+  if (ckpt.writer != nullptr) {
 
-        double value_recv;
-        res = MPI_Recv(&value_recv, 1, MPI_DOUBLE, node, Msg_tag, 
-                                       MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        EXIT_ON_MPI_FAILURE(res);
+    double max_stall;
+    res = MPI_Reduce(&ckpt.stall_time, &max_stall, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    EXIT_ON_MPI_FAILURE(res);
 
-        comp_scheme.set(x_idx, t_points-1, value_recv);
-      }      
+    if (rank == 0) {
+      std::cout << "Checkpoints: " << ckpt.writer->written() << " (loop stalled for " 
+                << max_stall << " sec) \n";
     }
+  }
+
+  double gather_start = MPI_Wtime();
 
+  /* Collect calculated values of the last layer on node №0 */
+  if (node != MPI_COMM_NULL) {
+    gather_layer_shm(comp_scheme, t_points-1, offsets, node, size, rank);
   } else {
+    gather_layer(comp_scheme, t_points-1, offsets, size, rank);
+  }
+
+  if (rank == 0) {
+    std::cout << "Gather: " << MPI_Wtime() - gather_start << " sec \n";
+  }
 
-    /* Send calculated values to node №0 */
-    for (uint64_t x_idx = x_idx_begin; x_idx < x_idx_end; ++x_idx) {
+  if (!options.output.empty()) {
 
-      double value_send = comp_scheme.get(x_idx, t_points-1);
-      res = MPI_Send(&value_send, 1, MPI_DOUBLE, 0, Msg_tag, MPI_COMM_WORLD);
-      EXIT_ON_MPI_FAILURE(res);
+    double write_start = MPI_Wtime();
+
+    /* Write the last layer into the binary file, each node writes own chunk */
+    write_layer(comp_scheme, t_points-1, options.output, x_idx_begin, x_idx_end);
+
+    if (rank == 0) {
+      std::cout << "Write: " << MPI_Wtime() - write_start << " sec \n";
     }
   }
 
@@ -188,6 +1053,12 @@ int main(int argc, char **argv)
   /* Free allocated arrays */
   comp_scheme.free();
 
+  if (node != MPI_COMM_NULL) {
+
+    res = MPI_Comm_free(&node);
+    EXIT_ON_MPI_FAILURE(res);
+  }
+
   /* Остановка среды MPI */
   res = MPI_Finalize();
   EXIT_ON_MPI_FAILURE(res);
@@ -0,0 +1,471 @@
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "mpi.h"
+#include "mpi_support.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "comp_math_2d.hpp"
+#include "options_2d.hpp"
+#include "field_mpi_io.hpp"
+#include "decomposition.hpp"
+
+/*
+ * Neighbours of the node in the Cartesian communicator are ordered
+ * as in the neighbour collectives: up, down (dimension 0), left, right (dimension 1)
+ */
+enum Neighbour { up = 0, down = 1, left = 2, right = 3, Neighbours = 4 };
+
+/*
+ * Arguments of MPI_Ineighbor_alltoallw exchanging the halo of one layer
+ * along one dimension. Displacements are in bytes from the layer start.
+ */
+struct Halo_exchange {
+
+  int counts[Neighbours] = {};
+  MPI_Aint send_displs[Neighbours] = {};
+  MPI_Aint recv_displs[Neighbours] = {};
+  MPI_Datatype types[Neighbours] = { MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE };
+
+  /* Row or column of the block, shared by both neighbours of the dimension */
+  MPI_Datatype halo = MPI_DATATYPE_NULL;
+};
+
+/* Byte offset of the point (i, j) of the layer with halo */
+static MPI_Aint point_displ(const Comp_scheme_2d& comp_scheme, uint64_t i, uint64_t j) {
+
+  return static_cast<MPI_Aint>((i * comp_scheme.stride() + j) * sizeof(double));
+}
+
+/*
+ * Exchange along x: first and last columns of the block go to the left
+ * and right neighbours, theirs are received into the halo columns.
+ * Column is described by MPI_Type_vector with the stride of the layer row.
+ */
+static Halo_exchange create_x_exchange(const Comp_scheme_2d& comp_scheme) {
+
+  uint64_t rows = comp_scheme.rows();
+  uint64_t cols = comp_scheme.cols();
+
+  MPI_Datatype column;
+  int res = MPI_Type_vector(static_cast<int>(rows), 1, static_cast<int>(comp_scheme.stride()),
+                            MPI_DOUBLE, &column);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&column);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Halo_exchange exchange;
+  exchange.halo = column;
+
+  for (int neigh : { left, right }) {
+    exchange.counts[neigh] = 1;
+    exchange.types[neigh] = column;
+  }
+
+  exchange.send_displs[left]  = point_displ(comp_scheme, 1, 1);
+  exchange.recv_displs[left]  = point_displ(comp_scheme, 1, 0);
+  exchange.send_displs[right] = point_displ(comp_scheme, 1, cols);
+  exchange.recv_displs[right] = point_displ(comp_scheme, 1, cols + 1);
+
+  return exchange;
+}
+
+/* Exchange along y: first and last rows of the block go to the upper and lower neighbours */
+static Halo_exchange create_y_exchange(const Comp_scheme_2d& comp_scheme) {
+
+  uint64_t rows = comp_scheme.rows();
+  uint64_t cols = comp_scheme.cols();
+
+  MPI_Datatype row;
+  int res = MPI_Type_vector(1, static_cast<int>(cols), static_cast<int>(comp_scheme.stride()),
+                            MPI_DOUBLE, &row);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&row);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Halo_exchange exchange;
+  exchange.halo = row;
+
+  for (int neigh : { up, down }) {
+    exchange.counts[neigh] = 1;
+    exchange.types[neigh] = row;
+  }
+
+  exchange.send_displs[up]   = point_displ(comp_scheme, 1, 1);
+  exchange.recv_displs[up]   = point_displ(comp_scheme, 0, 1);
+  exchange.send_displs[down] = point_displ(comp_scheme, rows, 1);
+  exchange.recv_displs[down] = point_displ(comp_scheme, rows + 1, 1);
+
+  return exchange;
+}
+
+static void free_exchange(Halo_exchange& exchange) {
+
+  int res = MPI_Type_free(&exchange.halo);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+static void start_exchange(double* layer, const Halo_exchange& exchange, MPI_Comm cart,
+                           MPI_Request* request) {
+
+  int res = MPI_Ineighbor_alltoallw(layer, exchange.counts, exchange.send_displs, exchange.types,
+                                    layer, exchange.counts, exchange.recv_displs, exchange.types,
+                                    cart, request);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+/*
+ * Split the region into the inner part, which does not use the halo
+ * along the sweep direction, and two edge strips next to the halo
+ */
+template <Sweep D>
+static void split_region(const Region& region, uint64_t size, Region& inner, Region edges[2]) {
+
+  uint64_t& begin = (D == Sweep::x)? inner.col_begin : inner.row_begin;
+  uint64_t& end   = (D == Sweep::x)? inner.col_end   : inner.row_end;
+
+  inner = region;
+
+  uint64_t region_begin = begin;
+  uint64_t region_end   = end;
+
+  /* Local points 1 and 'size' read the halo */
+  begin = std::max<uint64_t>(region_begin, 2);
+  end   = std::min<uint64_t>(region_end, size);
+
+  if (begin >= end) {
+    begin = end = region_end;
+  }
+
+  edges[0] = edges[1] = region;
+
+  if constexpr (D == Sweep::x) {
+    edges[0].col_end   = begin;
+    edges[1].col_begin = std::max(end, begin);
+  } else {
+    edges[0].row_end   = begin;
+    edges[1].row_begin = std::max(end, begin);
+  }
+}
+
+/*
+ * Time loop. Each step is two sweeps, the halo needed by the sweep
+ * is exchanged while the inner part of the block is computed.
+ * Returns time spent waiting for the exchanges.
+ */
+template <typename Bound>
+static double run(Comp_scheme_2d& comp_scheme, MPI_Comm cart,
+                  const Halo_exchange& x_exchange, const Halo_exchange& y_exchange, Bound psi) {
+
+  Region region = comp_scheme.compute_region();
+
+  Region x_inner, x_edges[2];
+  split_region<Sweep::x>(region, comp_scheme.cols(), x_inner, x_edges);
+
+  Region y_inner, y_edges[2];
+  split_region<Sweep::y>(region, comp_scheme.rows(), y_inner, y_edges);
+
+  double exposed_time = 0;
+
+  for (uint64_t t_idx = 0; t_idx < comp_scheme.t_points()-1; ++t_idx) {
+
+    MPI_Request request;
+
+    /* Intermediate layer takes the boundary values of the next time layer */
+    comp_scheme.set_boundary(comp_scheme.intermediate(), t_idx+1, psi);
+
+    start_exchange(comp_scheme.current(), x_exchange, cart, &request);
+    comp_scheme.sweep<Sweep::x>(x_inner, t_idx);
+
+    double wait_start = MPI_Wtime();
+    int res = MPI_Wait(&request, MPI_STATUS_IGNORE);
+    EXIT_ON_MPI_FAILURE(res);
+    exposed_time += MPI_Wtime() - wait_start;
+
+    comp_scheme.sweep<Sweep::x>(x_edges[0], t_idx);
+    comp_scheme.sweep<Sweep::x>(x_edges[1], t_idx);
+
+    start_exchange(comp_scheme.intermediate(), y_exchange, cart, &request);
+    comp_scheme.sweep<Sweep::y>(y_inner, t_idx);
+
+    wait_start = MPI_Wtime();
+    res = MPI_Wait(&request, MPI_STATUS_IGNORE);
+    EXIT_ON_MPI_FAILURE(res);
+    exposed_time += MPI_Wtime() - wait_start;
+
+    comp_scheme.sweep<Sweep::y>(y_edges[0], t_idx);
+    comp_scheme.sweep<Sweep::y>(y_edges[1], t_idx);
+
+    comp_scheme.set_boundary(comp_scheme.current(), t_idx+1, psi);
+  }
+
+  return exposed_time;
+}
+
+/* Collectively write the current layer into the binary field file, each node writes its block */
+static void write_layer(Comp_scheme_2d& comp_scheme, const std::string& path) {
+
+  uint64_t rows = comp_scheme.rows();
+  uint64_t cols = comp_scheme.cols();
+
+  /* Block without the halo inside the layer */
+  int sizes[2]    = { static_cast<int>(rows + 2), static_cast<int>(comp_scheme.stride()) };
+  int subsizes[2] = { static_cast<int>(rows), static_cast<int>(cols) };
+  int starts[2]   = { 1, 1 };
+
+  MPI_Datatype block;
+  int res = MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &block);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_commit(&block);
+  EXIT_ON_MPI_FAILURE(res);
+
+  FIELD::header header = FIELD::make_header_2d(comp_scheme.y_points(), comp_scheme.x_points(),
+                                               comp_scheme.h(), comp_scheme.h());
+
+  MPI_File file;
+  res = FIELD::mpi_create(MPI_COMM_WORLD, path.c_str(), header, &file);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = FIELD::mpi_write_block_all(file, header, comp_scheme.row_begin(), rows,
+                                   comp_scheme.col_begin(), cols, comp_scheme.current(), block);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = FIELD::mpi_close(&file);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Type_free(&block);
+  EXIT_ON_MPI_FAILURE(res);
+}
+
+int main(int argc, char **argv)
+{
+  int res, rank, size;
+
+#ifdef _OPENMP
+  /*
+   * Инициализация среды MPI. Внутри узла вычисления делятся между потоками OpenMP,
+   * вызовы MPI выполняются только главным потоком вне параллельных областей.
+   */
+  int provided;
+  res = MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (provided < MPI_THREAD_FUNNELED) {
+
+    std::cerr << "MPI implementation does not support MPI_THREAD_FUNNELED\n";
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+#else
+  /* Инициализация среды MPI */
+  res = MPI_Init(&argc, &argv);
+  EXIT_ON_MPI_FAILURE(res);
+#endif
+
+  /* Общее число процессов в коммуникаторе */
+  res = MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Ранг процесса */
+  res = MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  Solver_options_2d options;
+
+  try {
+
+    options = parse_options_2d(argc, argv);
+
+  } catch (const std::logic_error& exc) {
+
+    if (rank == 0) {
+      std::cerr << "Invalid options: " << exc.what() << "\n";
+      std::cerr << "Usage: " << argv[0] << " " << options_2d_usage() << "\n";
+    }
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
+  Comp_scheme_2d comp_scheme{
+    1e-3,              /* h        */
+    options.tau,       /* tau      */
+    options.x_points,  /* x_points */
+    options.y_points,  /* y_points */
+    options.t_points,  /* t_points */
+    1e-2,              /* ax       */
+    5e-3,              /* ay       */
+    options.scheme     /* scheme   */
+  };
+
+  /* Courant condition for both sweeps */
+  if (!comp_scheme.is_stable()) {
+
+    if (rank == 0) {
+      std::cerr << "Scheme is unstable with Courant numbers " << comp_scheme.courant_x()
+                << ", " << comp_scheme.courant_y() << ", decrease tau\n";
+    }
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
+  /* Process grid: dimension 0 splits the rows (y), dimension 1 the columns (x) */
+  int dims[2] = { 0, 0 };
+  res = MPI_Dims_create(size, 2, dims);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (options.y_points < static_cast<uint64_t>(dims[0]) ||
+      options.x_points < static_cast<uint64_t>(dims[1])) {
+
+    if (rank == 0) {
+      std::cerr << "Grid " << options.x_points << "x" << options.y_points
+                << " is too small for " << dims[1] << "x" << dims[0] << " nodes\n";
+    }
+
+    res = MPI_Finalize();
+    EXIT_ON_MPI_FAILURE(res);
+
+    return EXIT_FAILURE;
+  }
+
+  /* Boundary of the grid is not periodic, rank reordering is allowed */
+  int periods[2] = { 0, 0 };
+
+  MPI_Comm cart;
+  res = MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &cart);
+  EXIT_ON_MPI_FAILURE(res);
+
+  int cart_rank;
+  res = MPI_Comm_rank(cart, &cart_rank);
+  EXIT_ON_MPI_FAILURE(res);
+
+  int coords[2];
+  res = MPI_Cart_coords(cart, cart_rank, 2, coords);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Remainder rows and columns are spread over the first nodes of each dimension */
+  uint64_t row_begin = DECOMP::block_begin(options.y_points, dims[0], coords[0]);
+  uint64_t row_end   = DECOMP::block_begin(options.y_points, dims[0], coords[0] + 1);
+  uint64_t col_begin = DECOMP::block_begin(options.x_points, dims[1], coords[1]);
+  uint64_t col_end   = DECOMP::block_begin(options.x_points, dims[1], coords[1] + 1);
+
+  try {
+
+    comp_scheme.allocate(row_begin, row_end - row_begin, col_begin, col_end - col_begin);
+
+  } catch (const std::bad_alloc&) {
+
+    std::cerr << "Not enough memory for the block of node " << rank << "\n";
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+
+#ifdef DEBUG
+  std::cout << "[" << rank << "]" << " coords: " << coords[0] << " " << coords[1]
+                                  << " rows: [" << row_begin << "; " << row_end << ")"
+                                  << " cols: [" << col_begin << "; " << col_end << ")\n";
+#endif
+
+  /* u(0,x,y) = fi(x,y) */
+  auto fi = [](double x, double y) {
+    return 1000. * std::sin(x) * std::cos(y);
+  };
+  comp_scheme.set_initial(fi);
+
+  /* u(t,x,y) = psi(t) on the boundary of the grid */
+  auto psi = [](double arg) { return 100. * arg; };
+  comp_scheme.set_boundary(comp_scheme.current(), 0, psi);
+
+  Halo_exchange x_exchange = create_x_exchange(comp_scheme);
+  Halo_exchange y_exchange = create_y_exchange(comp_scheme);
+
+  if (rank == 0) {
+
+    std::cout << "Process grid: " << dims[1] << "x" << dims[0] << "\n";
+
+  #ifdef _OPENMP
+    std::cout << "Threads per node: " << omp_get_max_threads() << "\n";
+  #endif
+
+  }
+
+  MPI::stopwatch sw;
+  sw.start();
+
+  double exposed_time = run(comp_scheme, cart, x_exchange, y_exchange, psi);
+
+  /* Wait for all of the blocks to be calculated */
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    std::cout << "Elapsed: " << sw.stop() << " sec \n";
+  }
+
+  /* Longest wait of the nodes and the sum of the last layer for comparison between runs */
+  double local[2] = { exposed_time, 0 };
+
+  for (uint64_t i = 0; i < comp_scheme.rows(); ++i) {
+    for (uint64_t j = 0; j < comp_scheme.cols(); ++j) {
+      local[1] += comp_scheme.get(i, j);
+    }
+  }
+
+  double max_exposed, checksum;
+
+  res = MPI_Reduce(&local[0], &max_exposed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  res = MPI_Reduce(&local[1], &checksum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  EXIT_ON_MPI_FAILURE(res);
+
+  if (rank == 0) {
+    std::cout << "Exchange (exposed): " << max_exposed << " sec \n";
+    std::cout << "Checksum: " << std::setprecision(12) << checksum << "\n";
+  }
+
+  if (!options.output.empty()) {
+
+    double write_start = MPI_Wtime();
+
+    /* Write the last layer into the binary file, each node writes own block */
+    write_layer(comp_scheme, options.output);
+
+    if (rank == 0) {
+      std::cout << "Write: " << MPI_Wtime() - write_start << " sec \n";
+    }
+  }
+
+  free_exchange(x_exchange);
+  free_exchange(y_exchange);
+
+  res = MPI_Comm_free(&cart);
+  EXIT_ON_MPI_FAILURE(res);
+
+  /* Free allocated arrays */
+  comp_scheme.free();
+
+  /* Остановка среды MPI */
+  res = MPI_Finalize();
+  EXIT_ON_MPI_FAILURE(res);
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "comp_math.hpp"
+#include "options.hpp"
+
+/*
+ * Compares the scheme with the right-hand side and boundary functions
+ * known at compile time against the type-erased std::function ones.
+ * Each variant solves the same problem, best of 'Reps' runs is reported.
+ */
+
+static const unsigned Reps = 3U;
+
+/* Same problem as in the solvers */
+static double fi(double arg)  { return 1000. * std::sin(arg); }
+static double psi(double arg) { return 100. * arg; }
+
+template <typename Scheme_type, typename Fi, typename Psi>
+static double run(Scheme_type& comp_scheme, Fi fi_func, Psi psi_func, double& checksum) {
+
+  double best = 0;
+
+  for (unsigned rep = 0; rep < Reps; ++rep) {
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    uint64_t x_points = comp_scheme.x_points();
+
+    comp_scheme.set_boundary_coord(0, x_points, fi_func);
+    comp_scheme.set_boundary_time(0, psi_func);
+    comp_scheme.set_boundary_time(x_points-1, psi_func);
+
+    for (uint64_t t_idx = 0; t_idx < comp_scheme.t_points()-1; ++t_idx) {
+      comp_scheme.compute_range(1, x_points - 1, t_idx);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    best = (rep == 0)? elapsed.count() : std::min(best, elapsed.count());
+  }
+
+  checksum = 0;
+
+  for (uint64_t x_idx = 0; x_idx < comp_scheme.x_points(); ++x_idx) {
+    checksum += comp_scheme.get(x_idx, comp_scheme.t_points()-1);
+  }
+
+  return best;
+}
+
+template <typename Scheme_type, typename Fi, typename Psi>
+static void report(const std::string& name, Scheme_type&& comp_scheme, Fi fi_func, Psi psi_func) {
+
+  comp_scheme.allocate();
+
+  double checksum;
+  double time = run(comp_scheme, fi_func, psi_func, checksum);
+
+  comp_scheme.free();
+
+  double points = static_cast<double>(comp_scheme.x_points()) * comp_scheme.t_points();
+
+  std::cout << std::left << std::setw(24) << name
+            << std::right << std::setw(12) << time << " sec"
+            << std::setw(12) << 1e9 * time / points << " ns/point"
+            << "   checksum " << std::setprecision(12) << checksum << std::setprecision(6) << "\n";
+}
+
+int main(int argc, char** argv)
+{
+  Solver_options defaults;
+  defaults.x_points = 1000000;
+
+  Solver_options options;
+
+  try {
+
+    options = parse_options(argc, argv, defaults);
+
+    if (options.scheme == Scheme::implicit) {
+      throw std::invalid_argument("benchmark supports explicit schemes only");
+    }
+
+  } catch (const std::logic_error& exc) {
+
+    std::cerr << "Invalid options: " << exc.what() << "\n";
+    std::cerr << "Usage: " << argv[0] << " " << options_usage() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  double h = 1e-3, a = 1e-2;
+
+  using erased_rside = std::function<double(uint64_t, uint64_t)>;
+  using erased_bound = std::function<double(double)>;
+
+  auto source = [](uint64_t m, uint64_t k) { return 1e-3 * static_cast<double>(m + k); };
+
+  auto fi_lambda  = [](double arg) { return fi(arg); };
+  auto psi_lambda = [](double arg) { return psi(arg); };
+
+  std::cout << "Grid: " << options.x_points << " x " << options.t_points << "\n";
+
+  /* Homogeneous equation: no right-hand side against zero std::function */
+  report("homogeneous",
+         Comp_scheme{ h, options.tau, options.x_points, options.t_points, a, options.scheme },
+         fi_lambda, psi_lambda);
+
+  report("zero std::function",
+         Comp_scheme_erased{ h, options.tau, options.x_points, options.t_points, a, options.scheme,
+                             erased_rside{ [](uint64_t, uint64_t) { return 0.; } } },
+         erased_bound{ fi_lambda }, erased_bound{ psi_lambda });
+
+  /* Same non-zero right-hand side inlined and type-erased */
+  report("lambda rside",
+         Basic_comp_scheme{ h, options.tau, options.x_points, options.t_points, a, options.scheme,
+                            source },
+         fi_lambda, psi_lambda);
+
+  report("std::function rside",
+         Comp_scheme_erased{ h, options.tau, options.x_points, options.t_points, a, options.scheme,
+                             erased_rside{ source } },
+         erased_bound{ fi_lambda }, erased_bound{ psi_lambda });
+
+  return 0;
+}
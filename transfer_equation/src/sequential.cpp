@@ -2,46 +2,104 @@
 #include <iostream>
 #include <new>
 #include <cmath>
-#include <chrono>
+#include <stdexcept>
+#include <vector>
 
 #include "comp_math.hpp"
+#include "options.hpp"
+#include "stopwatch.hpp"
+#include "field_mmap.hpp"
 
-int main()
+int main(int argc, char **argv)
 {  
+  Solver_options options;
+
+  try {
+
+    options = parse_options(argc, argv, Solver_options{}, Option_set::sequential);
+
+  } catch (const std::logic_error& exc) {
+
+    std::cerr << "Invalid options: " << exc.what() << "\n";
+    std::cerr << "Usage: " << argv[0] << " " << options_usage(Option_set::sequential) << "\n";
+    return EXIT_FAILURE;
+  }
+
   Comp_scheme comp_scheme{
-    1e-3,     /* h        */
-    5e-6,     /* tau      */
-    10000008, /* x_points */
-    100,      /* t_points */
-    1e-2      /* a        */
+    1e-3,              /* h        */
+    options.tau,       /* tau      */
+    options.x_points,  /* x_points */
+    options.t_points,  /* t_points */
+    1e-2,              /* a        */
+    options.scheme     /* scheme   */
   };
 
+  /* Courant condition for the explicit schemes */
+  if (!comp_scheme.is_stable()) {
+
+    std::cerr << "Scheme is unstable with Courant number " << comp_scheme.courant() 
+              << ", decrease tau or use the implicit scheme\n";
+    return EXIT_FAILURE;
+  }
+
   comp_scheme.allocate();
 
   uint64_t x_points = comp_scheme.x_points();
   uint64_t t_points = comp_scheme.t_points();  
 
   /* u(0,x) = fi(x) */
-  Comp_scheme::bound_func_type fi  = [](double arg) -> double { return 1000. * std::sin(arg); };
+  auto fi  = [](double arg) -> double { return 1000. * std::sin(arg); };
   comp_scheme.set_boundary_coord(0, comp_scheme.x_points(), fi);
 
   /* u(t,0) = u(t,x_points-1) = psi(t) */
-  Comp_scheme::bound_func_type psi = [](double arg) { return 100. * arg; };
+  auto psi = [](double arg) { return 100. * arg; };
 
   comp_scheme.set_boundary_time(0, psi);
   comp_scheme.set_boundary_time(comp_scheme.x_points()-1, psi);
 
-  auto start_time = std::chrono::steady_clock::now();
+  UTILS::stopwatch sw;
+  sw.start();
+
+  /* Implicit scheme: whole layer forms a single block of the system */
+  std::vector<TRIDIAG::Row> reduced(2);
+  std::vector<double> interface;
 
   for (uint64_t t_idx = 0; t_idx < t_points-1; ++t_idx) {
 
-    /* Compute chunk */
-    comp_scheme.compute_range(1, x_points - 1, t_idx);
+    if (comp_scheme.scheme() == Scheme::implicit) {
+
+      comp_scheme.implicit_reduce(1, x_points - 1, t_idx, reduced.data());
+      TRIDIAG::solve_reduced(reduced, interface);
+      comp_scheme.implicit_expand(1, x_points - 1, t_idx, interface[0], interface[1]);
+
+    } else {
+
+      /* Compute chunk */
+      comp_scheme.compute_range(1, x_points - 1, t_idx);
+    }
   }
 
-  auto stop_time = std::chrono::steady_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (stop_time - start_time).count();
-  std::cout << "Elapsed: " << elapsed / 1000. << " sec \n";
+  std::cout << "Elapsed: " << sw.stop() << " sec \n";
+
+  /* Last layer in the same binary format as the parallel solvers write it */
+  if (!options.output.empty()) {
+
+    try {
+
+      FIELD::mapped_writer output(options.output, FIELD::make_header_1d(x_points, comp_scheme.h()));
+      double* layer = output.row(0);
+
+      for (uint64_t x_idx = 0; x_idx < x_points; ++x_idx) {
+        layer[x_idx] = comp_scheme.get(x_idx, t_points - 1);
+      }
+
+    } catch (const std::system_error& exc) {
+
+      std::cerr << "Failed to write " << options.output << ": " << exc.what() << "\n";
+      comp_scheme.free();
+      return EXIT_FAILURE;
+    }
+  }
 
 #ifdef PRINT 
   /* Print values */